@@ -0,0 +1,149 @@
+#include "bitplane.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace waveshare_epaper {
+namespace bitplane {
+
+// memcpy of a word compiles to a single load/store where alignment allows
+static inline uint32_t load_(const uint8_t *p) {
+  uint32_t word;
+  memcpy(&word, p, sizeof(word));
+  return word;
+}
+static inline void store_(uint8_t *p, uint32_t word) {
+  memcpy(p, &word, sizeof(word));
+}
+
+// libc already fills and copies word wide
+void fill(uint8_t *dst, uint8_t value, size_t length) {
+  memset(dst, value, length);
+}
+void copy(uint8_t *dst, const uint8_t *src, size_t length) {
+  memmove(dst, src, length);
+}
+
+void invert_copy(uint8_t *dst, const uint8_t *src, size_t length) {
+  size_t i = 0;
+  for (; i + 4 <= length; i += 4) store_(dst + i, ~load_(src + i));
+  for (; i < length; i++) dst[i] = ~src[i];
+}
+
+void fill_rect(uint8_t *plane, size_t stride, int x1, int y1, int x2, int y2,
+               uint8_t value) {
+  const int first = x1 / 8, last = (x2 - 1) / 8;
+  uint8_t head = 0xFF >> (x1 & 0x07);
+  const uint8_t tail = 0xFF << (7 - ((x2 - 1) & 0x07));
+  if (first == last) head &= tail;
+
+  uint8_t *row = plane + y1 * stride;
+  for (int y = y1; y < y2; y++, row += stride) {
+    row[first] = (row[first] & ~head) | (value & head);
+    if (first == last) continue;
+    fill(row + first + 1, value, last - first - 1);
+    row[last] = (row[last] & ~tail) | (value & tail);
+  }
+}
+
+// 8 source bits starting at bit `bit`, which may start before the row; bits
+// at or past `end` are not read
+static inline uint8_t get8_(const uint8_t *src, int bit, int end) {
+  if (bit < 0) return src[0] >> -bit;
+  const int pos = bit >> 3, shift = bit & 0x07;
+  uint8_t value = src[pos] << shift;
+  if (shift != 0 && (pos + 1) * 8 < end) value |= src[pos + 1] >> (8 - shift);
+  return value;
+}
+
+void blit(uint8_t *dst, size_t dst_stride, int dst_x, int dst_y,
+          const uint8_t *src, size_t src_stride, int src_x, int w, int h,
+          uint8_t fg, uint8_t bg, bool transparent) {
+  const int first = dst_x / 8, last = (dst_x + w - 1) / 8;
+  const uint8_t head = 0xFF >> (dst_x & 0x07);
+  const uint8_t tail = 0xFF << (7 - ((dst_x + w - 1) & 0x07));
+  const int end = src_x + w;
+
+  uint8_t *row = dst + dst_y * dst_stride;
+  for (int y = 0; y < h; y++, row += dst_stride, src += src_stride) {
+    // source bit landing on the first bit of destination byte `first`
+    int bit = src_x - (dst_x & 0x07);
+    for (int i = first; i <= last; i++, bit += 8) {
+      uint8_t mask = 0xFF;
+      if (i == first) mask &= head;
+      if (i == last) mask &= tail;
+      const uint8_t value = get8_(src, bit, end);
+      if (transparent) mask &= value;
+      const uint8_t pixels = (value & fg) | (~value & bg);
+      row[i] = (row[i] & ~mask) | (pixels & mask);
+    }
+  }
+}
+
+static inline uint8_t reverse_bits_(uint8_t value) {
+  value = (value & 0xF0) >> 4 | (value & 0x0F) << 4;
+  value = (value & 0xCC) >> 2 | (value & 0x33) << 2;
+  return (value & 0xAA) >> 1 | (value & 0x55) << 1;
+}
+
+void reverse_copy(uint8_t *dst, const uint8_t *src, size_t length) {
+  for (size_t i = 0; i < length; i++)
+    dst[i] = reverse_bits_(src[length - 1 - i]);
+}
+
+// Hacker's Delight transpose8rS32, rows packed MSB first into two words
+void transpose8(const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst,
+                ptrdiff_t dst_stride) {
+  uint32_t x = 0, y = 0;
+  for (int i = 0; i < 4; i++) {
+    x = (x << 8) | src[i * src_stride];
+    y = (y << 8) | src[(i + 4) * src_stride];
+  }
+  uint32_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA;
+  x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AA;
+  y = y ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC;
+  x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCC;
+  y = y ^ t ^ (t << 14);
+  t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+  y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+  x = t;
+  for (int i = 0; i < 4; i++) {
+    dst[i * dst_stride] = x >> (24 - 8 * i);
+    dst[(i + 4) * dst_stride] = y >> (24 - 8 * i);
+  }
+}
+
+size_t first_diff(const uint8_t *a, const uint8_t *b, size_t length) {
+  size_t i = 0;
+  while (i + 4 <= length && load_(a + i) == load_(b + i)) i += 4;
+  for (; i < length; i++) {
+    if (a[i] != b[i]) return i;
+  }
+  return length;
+}
+
+size_t last_diff(const uint8_t *a, const uint8_t *b, size_t length) {
+  size_t i = length;
+  while (i >= 4 && load_(a + i - 4) == load_(b + i - 4)) i -= 4;
+  while (i > 0) {
+    i--;
+    if (a[i] != b[i]) return i;
+  }
+  return length;
+}
+
+uint32_t hash(const uint8_t *src, size_t length) {
+  uint32_t h = 2166136261UL;
+  size_t i = 0;
+  for (; i + 4 <= length; i += 4) h = (h ^ load_(src + i)) * 16777619UL;
+  for (; i < length; i++) h = (h ^ src[i]) * 16777619UL;
+  return h;
+}
+
+}  // namespace bitplane
+}  // namespace waveshare_epaper
+}  // namespace esphome
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace waveshare_epaper {
+namespace bitplane {
+
+// Kernels over 1 bit per pixel planes, working a 32 bit word at a time.
+// Pointers and lengths do not need to be word aligned.
+
+void fill(uint8_t *dst, uint8_t value, size_t length);
+void copy(uint8_t *dst, const uint8_t *src, size_t length);
+// dst = ~src, dst may equal src
+void invert_copy(uint8_t *dst, const uint8_t *src, size_t length);
+// Set the pixels [x1, x2) x [y1, y2) of a plane with stride bytes per row to
+// value (0x00 or 0xFF), MSB first.
+void fill_rect(uint8_t *plane, size_t stride, int x1, int y1, int x2, int y2,
+               uint8_t value);
+// Copy a w x h bitmap (MSB first, src_stride bytes per row, starting at bit
+// src_x of each row) to pixel dst_x, dst_y of a plane. Set source bits write
+// fg, clear ones write bg, or are left alone if transparent.
+void blit(uint8_t *dst, size_t dst_stride, int dst_x, int dst_y,
+          const uint8_t *src, size_t src_stride, int src_x, int w, int h,
+          uint8_t fg, uint8_t bg, bool transparent);
+
+// dst = src in reverse pixel order (bytes reversed, bits within each byte
+// reversed), a 180 degree turn of a plane whose width is a multiple of 8.
+// dst must not overlap src.
+void reverse_copy(uint8_t *dst, const uint8_t *src, size_t length);
+// Transpose an 8 x 8 pixel block: bit i (MSB first) of dst row j is bit j of
+// src row i. Rows are stride bytes apart, strides may be negative.
+void transpose8(const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst,
+                ptrdiff_t dst_stride);
+
+// Offset of the first / last byte that differs, or length if a equals b.
+size_t first_diff(const uint8_t *a, const uint8_t *b, size_t length);
+size_t last_diff(const uint8_t *a, const uint8_t *b, size_t length);
+
+// FNV-1a over 32 bit words, for change detection only.
+uint32_t hash(const uint8_t *src, size_t length);
+
+}  // namespace bitplane
+}  // namespace waveshare_epaper
+}  // namespace esphome
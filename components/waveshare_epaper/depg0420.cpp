@@ -15,9 +15,19 @@ const char *const DEPG0420::TAG = "depg0420";
 RTC_DATA_ATTR uint32_t DEPG0420::at_update_ = 0;
 #endif
 
-int DEPG0420::get_width_internal() { return WIDTH; }
-
-int DEPG0420::get_height_internal() { return HEIGHT; }
+const uint8_t DEPG0420::INIT_SEQUENCE[] = {
+    0x12, SEQ_DELAY, 10,  // SWRESET, 4ms meaured
+    0x01, 3, (HEIGHT - 1) % 256, (HEIGHT - 1) / 256,
+    0x00,           // Driver output control
+    0x3C, 1, 0x05,  // BorderWavefrom
+    0x18, 1, 0x80,  // Read built-in temperature sensor
+    // set ram entry mode: x increase, y increase : normal mode
+    0x11, 1, 0x03,
+    0x44, 2, 0x00, (WIDTH - 1) / 8,
+    0x45, 4, 0x00, 0x00, (HEIGHT - 1) % 256, (HEIGHT - 1) / 256,
+    0x4e, 1, 0x00,
+    0x4f, 2, 0x00, 0x00,
+};
 
 uint32_t DEPG0420::idle_timeout_() { return IDLE_TIMEOUT; }
 
@@ -27,6 +37,7 @@ void DEPG0420::set_full_update_every(uint32_t full_update_every) {
 
 void DEPG0420::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
@@ -37,60 +48,57 @@ void DEPG0420::initialize() {
 #endif
 }
 
-void DEPG0420::display() {
-  bool full_update = this->at_update_ == 0;
+bool DEPG0420::prepare_display_() {
+  this->full_update_ = this->at_update_ == 0;
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
+  return true;
+}
 
-  uint32_t buf_len_half = this->get_buffer_length_() >> 1;
+void DEPG0420::write_band_(int y, int rows) {
+  const uint32_t length = rows * this->buffer_stride_();
+  const uint16_t y2 = y + rows - 1;
+  if (this->paged_())
+    this->queue_command_(0x45, y % 256, y / 256, y2 % 256, y2 / 256);
 
   // Write black Data
+  this->queue_command_(0x4e, 0x00);
+  this->queue_command_(0x4f, y % 256, y / 256);
   this->command(0x24);
   this->start_data_();
-  this->write_array(this->buffer_, buf_len_half);
+  this->write_plane_(this->buffer_, length);
   this->end_data_();
 
   // Write red Data
+  this->queue_command_(0x4e, 0x00);
+  this->queue_command_(0x4f, y % 256, y / 256);
   this->command(0x26);
   this->start_data_();
-  this->write_array(this->buffer_ + buf_len_half, buf_len_half);
+  this->write_plane_(this->buffer_ + this->plane_length_(), length);
   this->end_data_();
+}
 
-  if (full_update) {
-    this->command(0x22);  // Display Update Control
-    this->data(0xF7);
-
-    this->command(0x20);  // Activate Display Update Sequence
+bool DEPG0420::trigger_refresh_() {
+  if (this->full_update_) {
+    this->queue_command_(0x22, 0xF7);  // Display Update Control
+    this->queue_command_(0x20);  // Activate Display Update Sequence
   } else {
-    this->command(0x1A);  // Write to temperature register
-    this->data(0x5a);     // 90
-    this->data(0x00);
-
-    this->command(0x22);  // Display Update Sequence Options
-    this->data(0x91);     // Load LUT for temperature value
-
-    this->command(0x20);  // Master Activation
-    delay(2);             // less than 1 ms measured
-
-    this->command(0x22);  // Display Update Sequence Options
-    this->data(0xC7);     //
-
-    this->command(0x20);  // Master Activation
+    this->queue_command_(0x1A, 0x5a, 0x00);  // Write to temperature register: 90
+    // Display Update Sequence Options: Load LUT for temperature value
+    this->queue_command_(0x22, 0x91);
+    this->queue_command_(0x20);  // Master Activation
+    this->flush_commands_();
+    delay(2);  // less than 1 ms measured
+
+    this->queue_command_(0x22, 0xC7);  // Display Update Sequence Options
+    this->queue_command_(0x20);        // Master Activation
   }
-
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
-
-  this->status_clear_warning();
-
-  this->deep_sleep();
+  return true;
 }
 
+void DEPG0420::finish_display_() { this->deep_sleep(); }
+
 void DEPG0420::init_display_() {
   if (!initial_) {
     reset_();
@@ -99,39 +107,7 @@ void DEPG0420::init_display_() {
 
   if (hibernating_) reset_();
 
-  this->command(0x12);  // SWRESET
-  delay(10);            // 4ms meaured
-
-  this->command(0x01);  // Driver output control
-  this->data((HEIGHT - 1) % 256);
-  this->data((HEIGHT - 1) / 256);
-  this->data(0x00);
-
-  this->command(0x3C);  // BorderWavefrom
-  this->data(0x05);
-
-  this->command(0x18);  // Read built-in temperature sensor
-  this->data(0x80);
-
-  this->command(0x11);  // set ram entry mode
-  this->data(0x03);     // x increase, y increase : normal mode
-
-  this->command(0x44);
-  this->data(0x00);
-  this->data((WIDTH - 1) / 8);
-
-  this->command(0x45);
-  this->data(0x00);
-  this->data(0x00);
-  this->data((HEIGHT - 1) % 256);
-  this->data((HEIGHT - 1) / 256);
-
-  this->command(0x4e);
-  this->data(0x00);
-
-  this->command(0x4f);
-  this->data(0x00);
-  this->data(0x00);
+  this->run_sequence_(INIT_SEQUENCE, sizeof(INIT_SEQUENCE));
 }
 
 void DEPG0420::reset_() {
@@ -149,13 +125,11 @@ void DEPG0420::deep_sleep() {
   if (hibernating_) return;
 
   // power off
-  this->command(0x22);
-  this->data(0xc3);
-  this->command(0x20);
+  this->queue_command_(0x22, 0xc3);
+  this->queue_command_(0x20);
 
   if (this->reset_pin_ != nullptr) {
-    this->command(0x10);  // deep sleep
-    this->data(0x11);     // deep sleep
+    this->queue_command_(0x10, 0x11);  // deep sleep
   }
   hibernating_ = true;
 }
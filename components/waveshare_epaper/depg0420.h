@@ -3,22 +3,16 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class DEPG0420 : public WaveshareEPaperBWR {
+class DEPG0420 : public FixedGeometry<WaveshareEPaperBWR, 400, 300> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 400;
-
-  static const uint16_t HEIGHT = 300;
-
   static const uint16_t IDLE_TIMEOUT = 20000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
@@ -26,9 +20,13 @@ class DEPG0420 : public WaveshareEPaperBWR {
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
 
-  int get_height_internal() override;
+  void write_band_(int y, int rows) override;
+
+  bool trigger_refresh_() override;
+
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
@@ -36,6 +34,8 @@ class DEPG0420 : public WaveshareEPaperBWR {
 
   void init_display_();
 
+  static const uint8_t INIT_SEQUENCE[];
+
 #ifdef USE_ESP32
   static uint32_t at_update_;
 #else
@@ -44,7 +44,7 @@ class DEPG0420 : public WaveshareEPaperBWR {
 
   uint32_t full_update_every_{30};
 
-  bool initial_{false}, hibernating_{false};
+  bool initial_{false}, hibernating_{false}, full_update_{false};
 };
 
 }  // namespace waveshare_epaper
@@ -1,4 +1,4 @@
-from esphome import core, pins
+from esphome import automation, core, pins
 import esphome.codegen as cg
 from esphome.components import display, spi
 import esphome.config_validation as cv
@@ -13,10 +13,25 @@ from esphome.const import (
     CONF_PAGES,
     CONF_RESET_DURATION,
     CONF_RESET_PIN,
+    CONF_TRIGGER_ID,
 )
 
 DEPENDENCIES = ["spi"]
 
+CONF_ANTI_GHOSTING = "anti_ghosting"
+CONF_ASYNC_REFRESH = "async_refresh"
+CONF_BAND_HEIGHT = "band_height"
+CONF_BUFFER_PLACEMENT = "buffer_placement"
+CONF_BUSY_INTERRUPT = "busy_interrupt"
+CONF_LIGHT_SLEEP_DURING_REFRESH = "light_sleep_during_refresh"
+CONF_NATIVE_ROTATION = "native_rotation"
+CONF_ON_REFRESH = "on_refresh"
+CONF_PERSIST_FRAME = "persist_frame"
+CONF_PERSIST_FRAME_SIZE = "persist_frame_size"
+CONF_PREVIOUS_FRAME = "previous_frame"
+CONF_SKIP_UNCHANGED = "skip_unchanged"
+CONF_STANDBY_TIMEOUT = "standby_timeout"
+
 waveshare_epaper_ns = cg.esphome_ns.namespace("waveshare_epaper")
 WaveshareEPaperBase = waveshare_epaper_ns.class_(
     "WaveshareEPaperBase", cg.PollingComponent, spi.SPIDevice, display.DisplayBuffer
@@ -62,6 +77,26 @@ P750057MF1A = waveshare_epaper_ns.class_(
     "P750057MF1A", WaveshareEPaper
 )
 
+BufferPlacement = waveshare_epaper_ns.enum("BufferPlacement")
+BUFFER_PLACEMENTS = {
+    "auto": BufferPlacement.PLACEMENT_AUTO,
+    "psram": BufferPlacement.PLACEMENT_PSRAM,
+    "internal": BufferPlacement.PLACEMENT_INTERNAL,
+    "dma": BufferPlacement.PLACEMENT_DMA,
+    "static": BufferPlacement.PLACEMENT_STATIC,
+}
+
+FramePersistence = waveshare_epaper_ns.enum("FramePersistence")
+FRAME_PERSISTENCES = {
+    "none": FramePersistence.PERSIST_NONE,
+    "rtc": FramePersistence.PERSIST_RTC,
+    "flash": FramePersistence.PERSIST_FLASH,
+}
+
+RefreshTrigger = waveshare_epaper_ns.class_(
+    "RefreshTrigger", automation.Trigger.template()
+)
+
 
 MODELS = {
     "e0213a09": ("c", E0213A09),
@@ -77,6 +112,21 @@ MODELS = {
     "p750057-mf1-a": ("c", P750057MF1A),
 }
 
+# width, height and bit planes, as in the FixedGeometry of each driver
+MODEL_GEOMETRY = {
+    "e0213a09": (104, 212, 1),
+    "gdeh029a1": (128, 296, 1),
+    "gdem029t94": (128, 296, 1),
+    "gdew029t5d": (128, 296, 1),
+    "gdey029z95": (128, 296, 2),
+    "gdew042m01": (400, 300, 1),
+    "depg0420": (400, 300, 2),
+    "gdew042z15": (400, 300, 2),
+    "gdey075t7": (800, 480, 1),
+    "gdeq0426t82": (800, 480, 1),
+    "p750057-mf1-a": (800, 480, 2),
+}
+
 # Add proper logger
 _LOGGER = logging.getLogger(__name__)
 
@@ -95,6 +145,135 @@ def validate_full_update_every_only_types_ac(value):
         )
     return value
 
+ANTI_GHOSTING_MODELS = ("gdey075t7", "gdeq0426t82")
+
+
+def validate_anti_ghosting(value):
+    if CONF_ANTI_GHOSTING in value and value[CONF_MODEL] not in ANTI_GHOSTING_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_ANTI_GHOSTING}' is only supported for models: "
+            f"{', '.join(ANTI_GHOSTING_MODELS)}"
+        )
+    return value
+
+PREVIOUS_FRAME_MODELS = ("gdeq0426t82", "gdew029t5d", "gdew042m01", "gdey075t7")
+
+
+def validate_previous_frame(value):
+    if CONF_PREVIOUS_FRAME in value and value[CONF_MODEL] not in PREVIOUS_FRAME_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_PREVIOUS_FRAME}' is only supported for models: "
+            f"{', '.join(PREVIOUS_FRAME_MODELS)}"
+        )
+    return value
+
+PERSIST_FRAME_MODELS = ("gdeq0426t82", "gdew042m01", "gdey075t7")
+
+
+def validate_persist_frame(value):
+    if value.get(CONF_PERSIST_FRAME, "none") == "none":
+        return value
+    if value[CONF_MODEL] not in PERSIST_FRAME_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_PERSIST_FRAME}' is only supported for models: "
+            f"{', '.join(PERSIST_FRAME_MODELS)}"
+        )
+    if not core.CORE.is_esp32:
+        raise cv.Invalid(f"'{CONF_PERSIST_FRAME}' is only supported on the ESP32")
+    return value
+
+
+# header of the PersistedFrame record in waveshare_epaper.cpp
+PERSIST_HEADER_SIZE = 16
+# share of the 8 KB RTC slow memory the record may take
+PERSIST_RTC_LIMIT = 4096
+
+
+def validate_persist_frame_size(value):
+    persistence = value[CONF_PERSIST_FRAME]
+    if persistence == "none":
+        if CONF_PERSIST_FRAME_SIZE in value:
+            raise cv.Invalid(
+                f"'{CONF_PERSIST_FRAME_SIZE}' needs '{CONF_PERSIST_FRAME}'"
+            )
+        return value
+    size = value.setdefault(
+        CONF_PERSIST_FRAME_SIZE, 2048 if persistence == "rtc" else 4096
+    )
+    width, height, planes = MODEL_GEOMETRY[value[CONF_MODEL]]
+    frame = width // 8 * height * planes
+    if size > frame:
+        raise cv.Invalid(
+            f"'{CONF_PERSIST_FRAME_SIZE}' of {size} bytes is larger than the "
+            f"{frame} bytes frame of the {value[CONF_MODEL]}"
+        )
+    if persistence == "rtc" and size + PERSIST_HEADER_SIZE > PERSIST_RTC_LIMIT:
+        raise cv.Invalid(
+            f"'{CONF_PERSIST_FRAME_SIZE}' of {size} bytes does not fit in RTC "
+            f"memory, at most {PERSIST_RTC_LIMIT - PERSIST_HEADER_SIZE} bytes"
+        )
+    return value
+
+BAND_HEIGHT_MODELS = ("depg0420", "gdew042z15", "gdey029z95", "p750057-mf1-a")
+
+
+def validate_band_height(value):
+    if CONF_BAND_HEIGHT in value and value[CONF_MODEL] not in BAND_HEIGHT_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_BAND_HEIGHT}' is only supported for models: "
+            f"{', '.join(BAND_HEIGHT_MODELS)}"
+        )
+    return value
+
+STANDBY_MODELS = ("gdew029t5d", "gdew042m01")
+
+
+def buffer_sizes(config):
+    """Bytes of the frame buffer and of the full previous frame, 0 if none."""
+    width, height, planes = MODEL_GEOMETRY[config[CONF_MODEL]]
+    rows = min(config.get(CONF_BAND_HEIGHT, height), height)
+    frame = width // 8 * rows * planes
+    previous = 0
+    if (
+        config[CONF_MODEL] in PREVIOUS_FRAME_MODELS
+        and config.get(CONF_PREVIOUS_FRAME, "full") == "full"
+        # gdew029t5d keeps it in RTC memory on the ESP32
+        and not (config[CONF_MODEL] == "gdew029t5d" and core.CORE.is_esp32)
+    ):
+        previous = width // 8 * height
+    return frame, previous
+
+
+def report_ram_budget(value):
+    frame, previous = buffer_sizes(value)
+    placement = value[CONF_BUFFER_PLACEMENT]
+    _LOGGER.info(
+        "%s: frame buffer %d bytes, previous frame %d bytes, %d bytes in total "
+        "(%s)",
+        value[CONF_MODEL],
+        frame,
+        previous,
+        frame + previous,
+        "allocated statically" if placement == "static" else "allocated at boot",
+    )
+    return value
+
+
+def validate_esp32_only(value):
+    for key in (CONF_BUSY_INTERRUPT, CONF_LIGHT_SLEEP_DURING_REFRESH):
+        if value[key] and not core.CORE.is_esp32:
+            raise cv.Invalid(f"'{key}' is only supported on the ESP32")
+    return value
+
+
+def validate_standby_timeout(value):
+    if CONF_STANDBY_TIMEOUT in value and value[CONF_MODEL] not in STANDBY_MODELS:
+        raise cv.Invalid(
+            f"'{CONF_STANDBY_TIMEOUT}' is only supported for models: "
+            f"{', '.join(STANDBY_MODELS)}"
+        )
+    return value
+
 CONFIG_SCHEMA = cv.All(
     display.FULL_DISPLAY_SCHEMA.extend(
         {
@@ -108,11 +287,44 @@ CONFIG_SCHEMA = cv.All(
                 cv.positive_time_period_milliseconds,
                 cv.Range(max=core.TimePeriod(milliseconds=500)),
             ),
+            cv.Optional(CONF_ANTI_GHOSTING): cv.boolean,
+            cv.Optional(CONF_ASYNC_REFRESH, default=False): cv.boolean,
+            cv.Optional(CONF_BAND_HEIGHT): cv.int_range(min=1, max=65535),
+            cv.Optional(CONF_BUFFER_PLACEMENT, default="auto"): cv.enum(
+                BUFFER_PLACEMENTS, lower=True
+            ),
+            cv.Optional(CONF_BUSY_INTERRUPT, default=False): cv.boolean,
+            cv.Optional(CONF_LIGHT_SLEEP_DURING_REFRESH, default=False): cv.boolean,
+            cv.Optional(CONF_NATIVE_ROTATION, default=False): cv.boolean,
+            cv.Optional(CONF_PERSIST_FRAME, default="none"): cv.enum(
+                FRAME_PERSISTENCES, lower=True
+            ),
+            cv.Optional(CONF_PERSIST_FRAME_SIZE): cv.int_range(min=256),
+            cv.Optional(CONF_PREVIOUS_FRAME): cv.one_of(
+                "full", "compressed", lower=True
+            ),
+            cv.Optional(CONF_SKIP_UNCHANGED, default=True): cv.boolean,
+            cv.Optional(
+                CONF_STANDBY_TIMEOUT
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ON_REFRESH): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(RefreshTrigger),
+                }
+            ),
         }
     )
     .extend(cv.polling_component_schema("1s"))
     .extend(spi.spi_device_schema()),
     validate_full_update_every_only_types_ac,
+    validate_anti_ghosting,
+    validate_band_height,
+    validate_previous_frame,
+    validate_persist_frame,
+    validate_persist_frame_size,
+    validate_standby_timeout,
+    validate_esp32_only,
+    report_ram_budget,
     cv.has_at_most_one_key(CONF_PAGES, CONF_LAMBDA),
 )
 
@@ -135,8 +347,11 @@ async def to_code(config):
     cg.add(var.set_dc_pin(dc))
 
     if CONF_LAMBDA in config:
+        # `it` is the driver, so its byte wide drawing overloads are used
+        planes = MODEL_GEOMETRY[config[CONF_MODEL]][2]
+        driver = WaveshareEPaperBWR if planes == 2 else WaveshareEPaper
         lambda_ = await cg.process_lambda(
-            config[CONF_LAMBDA], [(display.DisplayRef, "it")], return_type=cg.void
+            config[CONF_LAMBDA], [(driver.operator("ref"), "it")], return_type=cg.void
         )
         cg.add(var.set_writer(lambda_))
     if CONF_RESET_PIN in config:
@@ -148,4 +363,41 @@ async def to_code(config):
     if CONF_FULL_UPDATE_EVERY in config and model_type in ("a", "c"):
         cg.add(var.set_full_update_every(config[CONF_FULL_UPDATE_EVERY]))
     if CONF_RESET_DURATION in config:
-        cg.add(var.set_reset_duration(config[CONF_RESET_DURATION]))
\ No newline at end of file
+        cg.add(var.set_reset_duration(config[CONF_RESET_DURATION]))
+    if CONF_ANTI_GHOSTING in config:
+        cg.add(var.set_anti_ghosting(config[CONF_ANTI_GHOSTING]))
+    cg.add(var.set_async_refresh(config[CONF_ASYNC_REFRESH]))
+    cg.add(var.set_buffer_placement(config[CONF_BUFFER_PLACEMENT]))
+    if config[CONF_BUFFER_PLACEMENT] == "static":
+        frame, previous = buffer_sizes(config)
+        name = f"{config[CONF_ID]}_frame_buffer"
+        cg.add_global(cg.RawStatement(f"alignas(4) static uint8_t {name}[{frame}];"))
+        cg.add(var.set_static_buffer(cg.RawExpression(name), frame))
+        if previous:
+            name = f"{config[CONF_ID]}_previous_frame"
+            cg.add_global(
+                cg.RawStatement(f"alignas(4) static uint8_t {name}[{previous}];")
+            )
+            cg.add(var.set_static_previous(cg.RawExpression(name), previous))
+    cg.add(var.set_busy_interrupt(config[CONF_BUSY_INTERRUPT]))
+    if CONF_BAND_HEIGHT in config:
+        cg.add(var.set_band_height(config[CONF_BAND_HEIGHT]))
+    cg.add(var.set_light_sleep(config[CONF_LIGHT_SLEEP_DURING_REFRESH]))
+    cg.add(var.set_native_rotation(config[CONF_NATIVE_ROTATION]))
+    if config[CONF_PERSIST_FRAME] != "none":
+        if config[CONF_PERSIST_FRAME] == "rtc":
+            cg.add_define("USE_WAVESHARE_EPAPER_PERSIST_RTC")
+        cg.add_define(
+            "USE_WAVESHARE_EPAPER_PERSIST_SIZE", config[CONF_PERSIST_FRAME_SIZE]
+        )
+        cg.add(var.set_frame_persistence(config[CONF_PERSIST_FRAME]))
+    if CONF_PREVIOUS_FRAME in config:
+        cg.add(
+            var.set_compress_previous(config[CONF_PREVIOUS_FRAME] == "compressed")
+        )
+    cg.add(var.set_skip_unchanged(config[CONF_SKIP_UNCHANGED]))
+    if CONF_STANDBY_TIMEOUT in config:
+        cg.add(var.set_standby_timeout(config[CONF_STANDBY_TIMEOUT]))
+    for conf in config.get(CONF_ON_REFRESH, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [], conf)
\ No newline at end of file
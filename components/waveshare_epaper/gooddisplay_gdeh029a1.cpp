@@ -25,9 +25,14 @@ const uint8_t GDEH029A1::LUT_DATA_PART[] = {
 RTC_DATA_ATTR uint32_t GDEH029A1::at_update_ = 0;
 #endif
 
-int GDEH029A1::get_width_internal() { return WIDTH; }
-
-int GDEH029A1::get_height_internal() { return HEIGHT; }
+const uint8_t GDEH029A1::INIT_SEQUENCE[] = {
+    0x01, 3, (HEIGHT - 1) % 256, (HEIGHT - 1) / 256,
+    0x00,                       // Panel configuration, Gate selection
+    0x0c, 3, 0xd7, 0xd6, 0x9d,  // softstart
+    0x2c, 1, 0xa8,              // VCOM setting: * different
+    0x3a, 1, 0x1a,              // DummyLine: 4 dummy line per gate
+    0x3b, 1, 0x08,              // Gatetime: 2us per line
+};
 
 uint32_t GDEH029A1::idle_timeout_() { return IDLE_TIMEOUT; }
 
@@ -37,6 +42,7 @@ void GDEH029A1::set_full_update_every(uint32_t full_update_every) {
 
 void GDEH029A1::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
@@ -47,40 +53,40 @@ void GDEH029A1::initialize() {
 #endif
 }
 
-void GDEH029A1::display() {
-  bool full_update = this->at_update_ == 0;
+bool GDEH029A1::prepare_display_() {
+  this->full_update_ = this->at_update_ == 0;
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
-  if (full_update) {
+  return true;
+}
+
+bool GDEH029A1::transfer_display_() {
+  if (this->full_update_) {
     this->cmd_data(0x32, LUT_DATA_FULL, sizeof(LUT_DATA_FULL));
   } else {
     this->cmd_data(0x32, LUT_DATA_PART, sizeof(LUT_DATA_PART));
   }
-  this->command(0x22);
-  this->data(0xc0);
-  this->command(0x20);
+  this->queue_command_(0x22, 0xc0);
+  this->queue_command_(0x20);
   if (!this->wait_until_idle_()) {
-    this->status_set_warning();
-    return;
+    return false;
   }
 
   this->setPartialRamArea_(0, 0, WIDTH, HEIGHT);
   this->command(0x24);
   this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
+  this->write_plane_(this->buffer_, this->get_buffer_length_());
   this->end_data_();
 
-  this->command(0x22);
-  this->data(full_update ? 0xC4 : 0x04);
-  this->command(0x20);
-  this->command(0xff);
-
-  this->status_clear_warning();
-
-  this->deep_sleep();
+  this->queue_command_(0x22, this->full_update_ ? 0xC4 : 0x04);
+  this->queue_command_(0x20);
+  this->queue_command_(0xff);
+  return true;
 }
 
+void GDEH029A1::finish_display_() { this->deep_sleep(); }
+
 void GDEH029A1::init_display_() {
   if (!initial_) {
     reset_();
@@ -89,24 +95,7 @@ void GDEH029A1::init_display_() {
 
   if (hibernating_) reset_();
 
-  this->command(0x01);  // Panel configuration, Gate selection
-  this->data((HEIGHT - 1) % 256);
-  this->data((HEIGHT - 1) / 256);
-  this->data(0x00);
-
-  this->command(0x0c);  // softstart
-  this->data(0xd7);
-  this->data(0xd6);
-  this->data(0x9d);
-
-  this->command(0x2c);  // VCOM setting
-  this->data(0xa8);     // * different
-
-  this->command(0x3a);  // DummyLine
-  this->data(0x1a);     // 4 dummy line per gate
-
-  this->command(0x3b);  // Gatetime
-  this->data(0x08);     // 2us per line
+  this->run_sequence_(INIT_SEQUENCE, sizeof(INIT_SEQUENCE));
   setPartialRamArea_(0, 0, WIDTH, HEIGHT);
 }
 
@@ -123,38 +112,24 @@ void GDEH029A1::reset_() {
 
 void GDEH029A1::setPartialRamArea_(uint16_t x, uint16_t y, uint16_t w,
                                    uint16_t h) {
-  this->command(0x11);  // set ram entry mode
-  this->data(0x03);     // x increase, y increase : normal mode
-
-  this->command(0x44);
-  this->data(x / 8);
-  this->data((x + w - 1) / 8);
-
-  this->command(0x45);
-  this->data(y % 256);
-  this->data(y / 256);
-  this->data((y + h - 1) % 256);
-  this->data((y + h - 1) / 256);
-
-  this->command(0x4e);
-  this->data(x / 8);
-
-  this->command(0x4f);
-  this->data(y % 256);
-  this->data(y / 256);
+  // set ram entry mode: x increase, y increase : normal mode
+  this->queue_command_(0x11, 0x03);
+  this->queue_command_(0x44, x / 8, (x + w - 1) / 8);
+  this->queue_command_(0x45, y % 256, y / 256, (y + h - 1) % 256,
+                       (y + h - 1) / 256);
+  this->queue_command_(0x4e, x / 8);
+  this->queue_command_(0x4f, y % 256, y / 256);
 }
 
 void GDEH029A1::deep_sleep() {
   if (hibernating_) return;
 
   // power off
-  this->command(0x22);
-  this->data(0xc3);
-  this->command(0x20);
+  this->queue_command_(0x22, 0xc3);
+  this->queue_command_(0x20);
 
   if (this->reset_pin_ != nullptr) {
-    this->command(0x10);  // deep sleep mode
-    this->data(0x1);      // enter deep sleep
+    this->queue_command_(0x10, 0x01);  // deep sleep mode: enter deep sleep
     hibernating_ = true;
   }
 }
@@ -3,22 +3,16 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class GDEH029A1 : public WaveshareEPaper {
+class GDEH029A1 : public FixedGeometry<WaveshareEPaper, 128, 296> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 128;
-
-  static const uint16_t HEIGHT = 296;
-
   static const uint16_t IDLE_TIMEOUT = 1000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
@@ -26,14 +20,21 @@ class GDEH029A1 : public WaveshareEPaper {
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
 
-  int get_height_internal() override;
+  bool transfer_display_() override;
+
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
+  // the refresh runs on into deep_sleep() without waiting for BUSY
+  bool refresh_uses_busy_() override { return false; }
+
   void init_display_();
 
+  static const uint8_t INIT_SEQUENCE[];
+
   void reset_();
 
   void setPartialRamArea_(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
@@ -48,7 +49,7 @@ class GDEH029A1 : public WaveshareEPaper {
 
   uint32_t full_update_every_{30};
 
-  bool initial_{false}, hibernating_{false};
+  bool initial_{false}, hibernating_{false}, full_update_{false};
 };
 
 }  // namespace waveshare_epaper
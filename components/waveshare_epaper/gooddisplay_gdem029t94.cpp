@@ -29,9 +29,14 @@ const uint8_t GDEM029T94::LUT_DATA_PART[] = {
 RTC_DATA_ATTR uint32_t GDEM029T94::at_update_ = 0;
 #endif
 
-int GDEM029T94::get_width_internal() { return WIDTH; }
-
-int GDEM029T94::get_height_internal() { return HEIGHT; }
+const uint8_t GDEM029T94::INIT_SEQUENCE[] = {
+    0x12, SEQ_DELAY, 10,        // SWRESET, 10ms according to specs
+    0x01, 3, 0x27, 0x01, 0x00,  // Driver output control
+    0x11, 1, 0x03,              // data entry mode
+    0x3C, 1, 0x05,              // BorderWavefrom
+    0x21, 2, 0x00, 0x80,        //  Display update control
+    0x18, 1, 0x80,              // Read built-in temperature sensor
+};
 
 uint32_t GDEM029T94::idle_timeout_() { return IDLE_TIMEOUT; }
 
@@ -41,6 +46,7 @@ void GDEM029T94::set_full_update_every(uint32_t full_update_every) {
 
 void GDEM029T94::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
@@ -51,54 +57,37 @@ void GDEM029T94::initialize() {
 #endif
 }
 
-void GDEM029T94::display() {
-  bool full_update = this->at_update_ == 0;
+bool GDEM029T94::prepare_display_() {
+  this->full_update_ = this->at_update_ == 0;
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
+  return true;
+}
 
-  if (full_update) {
-    this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
-
-    this->command(0x22);
-    this->data(0xf7);
-    this->command(0x20);
-    if (!this->wait_until_idle_()) {
-      this->status_set_warning();
-      return;
-    }
-
-    this->command(0x26);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
-  } else {
-    this->command(0x24);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+bool GDEM029T94::transfer_display_() {
+  this->command(0x24);
+  this->start_data_();
+  this->write_plane_(this->buffer_, this->get_buffer_length_());
+  this->end_data_();
 
+  if (this->full_update_) {
+    this->queue_command_(0x22, 0xf7);
+    this->queue_command_(0x20);
+  } else {
     this->cmd_data(0x32, LUT_DATA_PART, sizeof(LUT_DATA_PART));
 
-    this->command(0x22);
-    this->data(0xcc);
-    this->command(0x20);
-
-    if (!this->wait_until_idle_()) {
-      this->status_set_warning();
-      return;
-    }
-
-    this->command(0x26);
-    this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
-    this->end_data_();
+    this->queue_command_(0x22, 0xcc);
+    this->queue_command_(0x20);
   }
+  return true;
+}
 
-  this->status_clear_warning();
+void GDEM029T94::finish_display_() {
+  this->command(0x26);
+  this->start_data_();
+  this->write_plane_(this->buffer_, this->get_buffer_length_());
+  this->end_data_();
 
   this->deep_sleep();
 }
@@ -111,27 +100,8 @@ void GDEM029T94::init_display_() {
 
   if (hibernating_) reset_();
 
-  delay(10);            // 10ms according to specs
-  this->command(0x12);  // SWRESET
-
-  delay(10);            // 10ms according to specs
-  this->command(0x01);  // Driver output control
-  this->data(0x27);
-  this->data(0x01);
-  this->data(0x00);
-
-  this->command(0x11);  // data entry mode
-  this->data(0x03);
-
-  this->command(0x3C);  // BorderWavefrom
-  this->data(0x05);
-
-  this->command(0x21);  //  Display update control
-  this->data(0x00);
-  this->data(0x80);
-
-  this->command(0x18);  // Read built-in temperature sensor
-  this->data(0x80);
+  delay(10);  // 10ms according to specs
+  this->run_sequence_(INIT_SEQUENCE, sizeof(INIT_SEQUENCE));
   this->setPartialRamArea_(0, 0, WIDTH, HEIGHT);
 }
 
@@ -148,38 +118,24 @@ void GDEM029T94::reset_() {
 
 void GDEM029T94::setPartialRamArea_(uint16_t x, uint16_t y, uint16_t w,
                                     uint16_t h) {
-  this->command(0x11);  // set ram entry mode
-  this->data(0x03);     // x increase, y increase : normal mode
-
-  this->command(0x44);
-  this->data(x / 8);
-  this->data((x + w - 1) / 8);
-
-  this->command(0x45);
-  this->data(y % 256);
-  this->data(y / 256);
-  this->data((y + h - 1) % 256);
-  this->data((y + h - 1) / 256);
-
-  this->command(0x4e);
-  this->data(x / 8);
-
-  this->command(0x4f);
-  this->data(y % 256);
-  this->data(y / 256);
+  // set ram entry mode: x increase, y increase : normal mode
+  this->queue_command_(0x11, 0x03);
+  this->queue_command_(0x44, x / 8, (x + w - 1) / 8);
+  this->queue_command_(0x45, y % 256, y / 256, (y + h - 1) % 256,
+                       (y + h - 1) / 256);
+  this->queue_command_(0x4e, x / 8);
+  this->queue_command_(0x4f, y % 256, y / 256);
 }
 
 void GDEM029T94::deep_sleep() {
   if (hibernating_) return;
 
   // power off
-  this->command(0x22);
-  this->data(0x83);
-  this->command(0x20);
+  this->queue_command_(0x22, 0x83);
+  this->queue_command_(0x20);
 
   if (this->reset_pin_ != nullptr) {
-    this->command(0x10);  // deep sleep mode
-    this->data(0x1);      // enter deep sleep
+    this->queue_command_(0x10, 0x01);  // deep sleep mode: enter deep sleep
     hibernating_ = true;
   }
 }
@@ -9,9 +9,14 @@ namespace waveshare_epaper {
 
 const char *const GDEQ0426T82::TAG = "gdeq0426t82";
 
-int GDEQ0426T82::get_width_internal() { return WIDTH; }
-
-int GDEQ0426T82::get_height_internal() { return HEIGHT; }
+const uint8_t GDEQ0426T82::INIT_SEQUENCE[] = {
+    0x12, SEQ_DELAY, 10,  // SWRESET, 10ms according to specs
+    0x18, 1, 0x80,        // internal temperature sensor
+    0x0C, 5, 0xAE, 0xC7, 0xC3, 0xC0, 0x80,  // soft start
+    // Driver output control: gates A0..A7, gates A8, A9, SM (interlaced) ??
+    0x01, 3, (HEIGHT - 1) % 256, (HEIGHT - 1) / 256, 0x02,
+    0x3C, 1, 0x01,  // BorderWavefrom
+};
 
 uint32_t GDEQ0426T82::idle_timeout_() { return IDLE_TIMEOUT; }
 
@@ -21,163 +26,161 @@ void GDEQ0426T82::set_full_update_every(uint32_t full_update_every) {
 
 void GDEQ0426T82::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
-void GDEQ0426T82::initialize() {}
+void GDEQ0426T82::initialize() {
+  this->init_previous_(&this->at_update_);
+}
 
-void GDEQ0426T82::display() {
-  RefreshMode mode = this->at_update_ == 0 ? FULL_REFRESH : PARTIAL_REFRESH;
+bool GDEQ0426T82::prepare_display_() {
+  this->mode_ = this->at_update_ == 0 ? FULL_REFRESH : PARTIAL_REFRESH;
+  if (this->mode_ == PARTIAL_REFRESH && !this->trim_dirty_()) {
+    ESP_LOGD(TAG, "Frame unchanged, skipping partial refresh");
+    return false;
+  }
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
+  return true;
+}
 
-  this->write_buffer_(mode);
-
-  this->status_clear_warning();
-
-  this->deep_sleep();
+bool GDEQ0426T82::transfer_display_() {
+  return this->write_buffer_(this->mode_);
 }
 
+void GDEQ0426T82::finish_display_() { this->deep_sleep(); }
+
 void GDEQ0426T82::init_display_() {
   reset_();
   delay(10);
-  this->command(0x12);  //SWRESET
-  delay(10); // 10ms according to specs
-  this->command(0x18);
-  this->data(0x80);
-  this->command(0x0C);
-  this->data(0xAE);
-  this->data(0xC7);
-  this->data(0xC3);
-  this->data(0xC0);
-  this->data(0x80);
-  this->command(0x01); // Driver output control
-  this->data((HEIGHT - 1) % 256); // gates A0..A7
-  this->data((HEIGHT - 1) / 256); // gates A8, A9
-  this->data(0x02); // SM (interlaced) ??
-  this->command(0x3C); // BorderWavefrom
-  this->data(0x01);
+  this->run_sequence_(INIT_SEQUENCE, sizeof(INIT_SEQUENCE));
 }
 
-void GDEQ0426T82::write_buffer_(RefreshMode mode) {
-  const uint16_t x = 0;
-  const uint16_t y = 0;
-  this->command(0x21); // Display Update Controll
-  this->data(0x40);    // bypass RED as 0
-  this->data(0x00); 
+bool GDEQ0426T82::write_buffer_(RefreshMode mode) {
+  // Display Update Controll: bypass RED as 0
+  this->queue_command_(0x21, 0x40, 0x00);
   switch (mode) {
     case FULL_REFRESH:
-      this->clear_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-        oldData_[i] = 0xff;
+      if (this->anti_ghosting_) {
+        // blank the panel, then draw the frame with a partial update; the
+        // blanking refresh is waited for here, also with async_refresh
+        if (!this->clear_()) return false;
+        this->clear_previous_();
+        this->mark_all_dirty_();
+        return this->write_buffer_(PARTIAL_REFRESH);
       }
-      this->write_buffer_(PARTIAL_REFRESH);
-      return;
+
+      // single full waveform, red RAM is bypassed as 0
+      this->set_ram_area_(0, 0, WIDTH - 1, HEIGHT - 1);
+      if (!this->fill_ram_(0x26, 0xff, this->get_buffer_length_()))
+        return false;
+      this->command(0x24);  // writes New data to SRAM.
+      this->start_data_();
+      this->write_plane_(this->buffer_, this->get_buffer_length_());
+      this->end_data_();
+      this->new_ram_valid_ = true;
+
+      this->queue_command_(0x22, 0xF7);  // Display Update Control: full
+      this->queue_command_(0x20);        // Master Activation
+      return true;
 
     case FAST_REFRESH:
-    this->command(0x1A); // Write to temperature register
-    this->data(0x5A);
-    this->command(0x22);
-    this->data(0xd7);
+      this->queue_command_(0x1A, 0x5A);  // Write to temperature register
+      this->queue_command_(0x22, 0xd7);
 
       // Write old Data
-      this->command(0x26);
-      this->start_data_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-        this->write_byte(0x00);
-      this->end_data_();
+      this->set_ram_area_(0, 0, WIDTH - 1, HEIGHT - 1);
+      if (!this->fill_ram_(0x26, 0x00, this->get_buffer_length_()))
+        return false;
 
       // Write new Data
       this->command(0x24);  // writes New data to SRAM.
       this->start_data_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-        this->write_byte(~this->buffer_[i]);
-        oldData_[i] = this->buffer_[i];
-      }
+      this->write_plane_(this->buffer_, this->get_buffer_length_(), true);
       this->end_data_();
+      // inverted, not the frame a partial update diffs against
+      this->new_ram_valid_ = false;
       break;
 
-    case PARTIAL_REFRESH:
-      this->command(0x21); // Display Update Controll
-      this->data(0x00);    // RED normal
-      this->data(0x00);    // single chip application
-      this->command(0x22);
-      this->data(0xfc);
-      this->command(0x20);
-
-      this->command(0x11); // set ram entry mode
-      this->data(0x01);    // x increase, y decrease : y reversed
-      this->command(0x44);
-      this->data(x % 256);
-      this->data(x / 256);
-      this->data((x + WIDTH - 1) % 256);
-      this->data((x + WIDTH - 1) / 256);
-      this->command(0x45);
-      this->data((y + HEIGHT - 1) % 256);
-      this->data((y + HEIGHT - 1) / 256);
-      this->data(y % 256);
-      this->data(y / 256);
-      this->command(0x4e);
-      this->data(x % 256);
-      this->data(x / 256);
-      this->command(0x4f);
-      this->data((y + HEIGHT - 1) % 256);
-      this->data((y + HEIGHT - 1) / 256);
-
-      this->command(0x26);
-      this->start_data_();
-      this->write_array(this->oldData_, this->get_buffer_length_());
-      this->end_data_();
+    case PARTIAL_REFRESH: {
+      // Display Update Controll: RED normal, single chip application
+      this->queue_command_(0x21, 0x00, 0x00);
+      this->queue_command_(0x22, 0xfc);
+      this->queue_command_(0x20);
+
+      // The waveform runs over the whole panel, so the old RAM must hold
+      // the shown frame everywhere, not only inside the dirty window.
+      // After clear_() the old frame is blank, filled on chip.
+      this->set_ram_area_(0, 0, WIDTH - 1, HEIGHT - 1);
+      if (this->mode_ == FULL_REFRESH) {
+        if (!this->fill_ram_(0x26, 0xff, this->get_buffer_length_()))
+          return false;
+      } else {
+        this->command(0x26);
+        this->start_data_();
+        this->write_previous_();
+        this->end_data_();
+      }
 
+      // Outside the window the new RAM still holds the shown frame, once it
+      // was written in full since power-up. Before that it is undefined.
+      if (this->new_ram_valid_)
+        this->set_ram_area_(this->dirty_x1_, this->dirty_y1_,
+                            this->dirty_x2_, this->dirty_y2_);
       this->command(0x24);  // writes New data to SRAM.
       this->start_data_();
-      this->write_array(this->buffer_, this->get_buffer_length_());
+      if (this->new_ram_valid_) {
+        this->write_dirty_window_(this->buffer_);
+      } else {
+        this->write_plane_(this->buffer_, this->get_buffer_length_());
+      }
       this->end_data_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-        oldData_[i] = this->buffer_[i];
+      this->new_ram_valid_ = true;
 
       this->command(0x92);
       break;
+    }
 
     default:
       ESP_LOGE(TAG, "unsupported refresh mode, mode:%d", mode);
-      return;
+      return false;
   }
 
   this->command(0x12);  // DISPLAY update
   delay(1);             //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
+  return true;
 }
 
-void GDEQ0426T82::clear_() {
-  // Write old Data
-  this->command(0x26);
-  this->start_data_();
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0x00);
-  this->end_data_();
+// Window of buffer rows y1..y2 and columns x1..x2 (inclusive, x in pixels).
+// RAM rows run bottom-up, so the buffer rows are mirrored.
+void GDEQ0426T82::set_ram_area_(uint16_t x1, uint16_t y1, uint16_t x2,
+                                uint16_t y2) {
+  const uint16_t ram_y1 = HEIGHT - 1 - y1;
+  const uint16_t ram_y2 = HEIGHT - 1 - y2;
+
+  // set ram entry mode: x increase, y decrease : y reversed
+  this->queue_command_(0x11, 0x01);
+  this->queue_command_(0x44, x1 % 256, x1 / 256, x2 % 256, x2 / 256);
+  this->queue_command_(0x45, ram_y1 % 256, ram_y1 / 256, ram_y2 % 256,
+                       ram_y2 / 256);
+  this->queue_command_(0x4e, x1 % 256, x1 / 256);
+  this->queue_command_(0x4f, ram_y1 % 256, ram_y1 / 256);
+}
 
+bool GDEQ0426T82::clear_() {
+  this->set_ram_area_(0, 0, WIDTH - 1, HEIGHT - 1);
+  // Write old Data
+  if (!this->fill_ram_(0x26, 0x00, this->get_buffer_length_())) return false;
   // Write new Data
-  this->command(0x24);
-  this->start_data_();
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0x00);
-  this->end_data_();
+  this->new_ram_valid_ = false;
+  if (!this->fill_ram_(0x24, 0x00, this->get_buffer_length_())) return false;
 
   this->command(0x12);  // DISPLAY update
   delay(1);             //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
+  return this->wait_until_idle_();  // waiting for the electronic paper IC to
+                                    // release the idle signal
 }
 
 void GDEQ0426T82::reset_() {
@@ -190,19 +193,16 @@ void GDEQ0426T82::reset_() {
 }
 
 void GDEQ0426T82::deep_sleep() {
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0xf7);     // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7
-                        // VBDW 77 VBDB 37  VBDR B7
-
-this->command(0x22);
-    this->data(0x83);
-    this->command(0x20);
+  // VCOM AND DATA INTERVAL SETTING
+  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  this->queue_command_(0x50, 0xf7);
+  this->queue_command_(0x22, 0x83);  // power off
+  this->queue_command_(0x20);
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
     return;
 
-  this->command(0x10);  // deep sleep
-  this->data(0x1);
+  this->queue_command_(0x10, 0x01);  // deep sleep
 }
 
 void GDEQ0426T82::dump_config() {
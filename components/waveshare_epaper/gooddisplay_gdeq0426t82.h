@@ -3,32 +3,37 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class GDEQ0426T82 : public WaveshareEPaper {
+class GDEQ0426T82 : public FixedGeometry<WaveshareEPaper, 800, 480> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 800;
-
-  static const uint16_t HEIGHT = 480;
-
   static const uint16_t IDLE_TIMEOUT = 6000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
 
+  void set_anti_ghosting(bool anti_ghosting) {
+    this->anti_ghosting_ = anti_ghosting;
+  }
+
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
+
+  bool transfer_display_() override;
+
+  void finish_display_() override;
 
-  int get_height_internal() override;
+  // SSD1677: steps of 680 rows and 960 columns
+  bool fill_ram_(uint8_t ram_cmd, uint8_t value, size_t length) override {
+    return this->ssd_auto_write_ram_(ram_cmd, value, length, 0x77);
+  }
 
   uint32_t idle_timeout_() override;
 
@@ -36,15 +41,25 @@ class GDEQ0426T82 : public WaveshareEPaper {
 
   void init_display_();
 
-  void write_buffer_(RefreshMode mode);
+  static const uint8_t INIT_SEQUENCE[];
 
-  void clear_();
+  bool write_buffer_(RefreshMode mode);
 
-  void reset_();
+  bool clear_();
+
+  void set_ram_area_(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
 
-  uint8_t oldData_[WIDTH * HEIGHT / 8];
+  void reset_();
 
   uint32_t at_update_{0}, full_update_every_{30};
+
+  bool anti_ghosting_{false};
+
+  // the new RAM (0x24) holds the shown frame, it was written in full since
+  // power-up
+  bool new_ram_valid_{false};
+
+  RefreshMode mode_{FULL_REFRESH};
 };
 
 }  // namespace waveshare_epaper
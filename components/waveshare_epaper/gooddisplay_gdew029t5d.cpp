@@ -2,6 +2,7 @@
 
 #include <cstdint>
 
+#include "bitplane.h"
 #include "esphome/core/log.h"
 
 // Reference: https://www.good-display.com/product/210.html
@@ -42,10 +43,6 @@ RTC_DATA_ATTR uint32_t GDEW029T5D::at_update_ = 0;
 RTC_DATA_ATTR uint8_t GDEW029T5D::oldData[WIDTH * HEIGHT / 8u];
 #endif
 
-int GDEW029T5D::get_width_internal() { return WIDTH; }
-
-int GDEW029T5D::get_height_internal() { return HEIGHT; }
-
 uint32_t GDEW029T5D::idle_timeout_() { return IDLE_TIMEOUT; }
 
 void GDEW029T5D::set_full_update_every(uint32_t full_update_every) {
@@ -54,6 +51,7 @@ void GDEW029T5D::set_full_update_every(uint32_t full_update_every) {
 
 void GDEW029T5D::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
@@ -61,58 +59,70 @@ void GDEW029T5D::initialize() {
 #ifdef USE_ESP32
   esp_reset_reason_t reason = esp_reset_reason();
   if (reason == ESP_RST_EXT) this->at_update_ = 0;
+  // oldData has to survive deep sleep as it is
+  this->compress_previous_ = false;
+#else
+  this->init_previous_();
 #endif
 }
 
-void GDEW029T5D::display() {
-  bool full_update = this->at_update_ == 0;
+bool GDEW029T5D::prepare_display_() {
+  this->full_update_ = this->at_update_ == 0;
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
+  return true;
+}
 
-  if (full_update) {
+bool GDEW029T5D::transfer_display_() {
+  if (this->full_update_) {
     // Write Data
-    this->command(0x10);  // Transfer old data
-    for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-      this->data(0xFF);  // Transfer the actual displayed data
+    // Transfer old data
+    this->fill_ram_(0x10, 0xFF, this->get_buffer_length_());
 
     this->command(0x13);  // Transfer new data
     this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
+    this->write_plane_(this->buffer_, this->get_buffer_length_());
     this->end_data_();
-    for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-      oldData[i] = this->buffer_[i];
   } else {
     this->init_part_();
 
     // Write Data
     this->command(0x10);  // Transfer old data
     this->start_data_();
-    this->write_array(oldData, this->get_buffer_length_());
+#ifdef USE_ESP32
+    this->write_plane_(oldData, this->get_buffer_length_());
+#else
+    this->write_previous_();
+#endif
     this->end_data_();
 
     this->command(0x13);  // Transfer new data
     this->start_data_();
-    this->write_array(this->buffer_, this->get_buffer_length_());
+    this->write_plane_(this->buffer_, this->get_buffer_length_());
     this->end_data_();
-    for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-      oldData[i] = this->buffer_[i];
   }
 
   this->command(0x12);  // DISPLAY REFRESH
   delay(1);             //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
+  return true;
+}
+
+void GDEW029T5D::finish_display_() {
+  if (this->defer_deep_sleep_()) {
+    this->power_off_();
     return;
   }
-
-  this->status_clear_warning();
-
   this->deep_sleep();
 }
 
+#ifdef USE_ESP32
+void GDEW029T5D::on_frame_shown_() {
+  bitplane::copy(oldData, this->buffer_, this->get_buffer_length_());
+  WaveshareEPaper::on_frame_shown_();
+}
+#endif
+
 void GDEW029T5D::init_display_() {
   if (!initial_) {
     reset_();
@@ -121,23 +131,19 @@ void GDEW029T5D::init_display_() {
 
   if (hibernating_) reset_();
 
-  this->command(0x00);  // panel setting
-  this->data(0x1f);     // LUT from OTP��?KW-BF   KWR-AF  BWROTP 0f BWOTP 1f
-  this->data(0x0D);
-
-  this->command(0x61);  // resolution setting
-  this->data(WIDTH);
-  this->data(HEIGHT / 256);
-  this->data(HEIGHT % 256);
-
-  this->command(0x04);
+  // panel setting: LUT from OTP  KW-BF   KWR-AF  BWROTP 0f BWOTP 1f
+  this->queue_register_(0x00, this->panel_setting_(0x1f), 0x0D);
+  this->queue_register_(0x61, WIDTH, HEIGHT / 256,
+                        HEIGHT % 256);  // resolution setting
+  this->queue_command_(0x04);           // power on
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
     return;
+  powered_ = true;
 
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0x97);  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW
-                     // 77 VBDB 37  VBDR B7
+  // VCOM AND DATA INTERVAL SETTING
+  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  this->queue_register_(0x50, 0x97);
 }
 
 void GDEW029T5D::reset_() {
@@ -151,39 +157,25 @@ void GDEW029T5D::reset_() {
     this->wait_until_idle_();
   }
 
+  // registers are back at their defaults
+  this->clear_shadow_();
   hibernating_ = false;
+  powered_ = false;
 }
 
 void GDEW029T5D::init_part_() {
-  this->command(0x01);  // POWER SETTING
-  this->data(0x03);
-  this->data(0x00);
-  this->data(0x2b);
-  this->data(0x2b);
-  this->data(0x03);
-
-  this->command(0x06);  // boost soft start
-  this->data(0x17);     // A
-  this->data(0x17);     // B
-  this->data(0x17);     // C
-
-  this->command(0x00);  // panel setting
-  this->data(0xbf);     // LUT from OTP��?128x296
-  this->data(0x0D);
-
-  this->command(0x30);
-  this->data(0x3C);  // 3A 100HZ   29 150Hz 39 200HZ  31 171HZ
-
-  this->command(0x61);  // resolution setting
-  this->data(WIDTH);
-  this->data(HEIGHT / 256);
-  this->data(HEIGHT % 256);
-
-  this->command(0x82);  // vcom_DC setting
-  this->data(0x12);
+  this->queue_register_(0x01, 0x03, 0x00, 0x2b, 0x2b, 0x03);  // POWER SETTING
+  this->queue_register_(0x06, 0x17, 0x17, 0x17);  // boost soft start A, B, C
+  // panel setting: LUT from register, 128x296
+  this->queue_register_(0x00, this->panel_setting_(0xbf), 0x0D);
+  // PLL setting: 3A 100HZ   29 150Hz 39 200HZ  31 171HZ
+  this->queue_register_(0x30, 0x3C);
+  this->queue_register_(0x61, WIDTH, HEIGHT / 256,
+                        HEIGHT % 256);  // resolution setting
+  this->queue_register_(0x82, 0x12);    // vcom_DC setting
   write_lut_();
 
-  this->command(0x04);
+  this->queue_command_(0x04);  // power on
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
   {
@@ -193,28 +185,35 @@ void GDEW029T5D::init_part_() {
 }
 
 void GDEW029T5D::write_lut_() {
-  this->cmd_data(0x20, LUT_VCOM1, sizeof(LUT_VCOM1));
-  this->cmd_data(0x21, LUT_WW1, sizeof(LUT_WW1));
-  this->cmd_data(0x22, LUT_BW1, sizeof(LUT_BW1));
-  this->cmd_data(0x23, LUT_WB1, sizeof(LUT_WB1));
-  this->cmd_data(0x24, LUT_BB1, sizeof(LUT_BB1));
+  this->write_register_(0x20, LUT_VCOM1, sizeof(LUT_VCOM1));
+  this->write_register_(0x21, LUT_WW1, sizeof(LUT_WW1));
+  this->write_register_(0x22, LUT_BW1, sizeof(LUT_BW1));
+  this->write_register_(0x23, LUT_WB1, sizeof(LUT_WB1));
+  this->write_register_(0x24, LUT_BB1, sizeof(LUT_BB1));
 }
 
-void GDEW029T5D::deep_sleep() {
-  if (hibernating_) return;
-
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0xf7);     // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7
-                        // VBDW 77 VBDB 37  VBDR B7
+// Registers and LUTs are kept while powered off, only deep sleep loses them.
+bool GDEW029T5D::power_off_() {
+  if (!powered_) return true;
 
-  this->command(0x02);            // power off
+  // VCOM AND DATA INTERVAL SETTING
+  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  this->queue_register_(0x50, 0xf7);
+  this->queue_command_(0x02);     // power off
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
-    return;
+    return false;
+  powered_ = false;
+  return true;
+}
+
+void GDEW029T5D::deep_sleep() {
+  if (hibernating_) return;
+
+  if (!this->power_off_()) return;
 
-  delay(100);           //!!!The delay here is necessary,100mS at least!!!
-  this->command(0x07);  // deep sleep
-  this->data(0xA5);
+  delay(100);  //!!!The delay here is necessary,100mS at least!!!
+  this->queue_command_(0x07, 0xA5);  // deep sleep
   hibernating_ = true;
 }
 
@@ -226,6 +225,9 @@ void GDEW029T5D::dump_config() {
   LOG_PIN("  DC Pin: ", this->dc_pin_)
   LOG_PIN("  Busy Pin: ", this->busy_pin_)
   LOG_UPDATE_INTERVAL(this);
+  if (this->standby_timeout_ != 0)
+    ESP_LOGCONFIG(TAG, "  Standby Timeout: %" PRIu32 " ms",
+                  this->standby_timeout_);
 }
 
 }  // namespace waveshare_epaper
@@ -3,22 +3,16 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class GDEW029T5D : public WaveshareEPaper {
+class GDEW029T5D : public FixedGeometry<WaveshareEPaper, 128, 296> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 128;
-
-  static const uint16_t HEIGHT = 296;
-
   static const uint16_t IDLE_TIMEOUT = 6000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
@@ -26,14 +20,18 @@ class GDEW029T5D : public WaveshareEPaper {
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
+
+  bool transfer_display_() override;
 
-  int get_height_internal() override;
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
   bool is_busy_pin_inverted_() override { return true; }
 
+  bool can_flip_scan_() override { return true; }
+
   void init_display_();
 
   void init_part_();
@@ -42,21 +40,25 @@ class GDEW029T5D : public WaveshareEPaper {
 
   void write_lut_();
 
+  bool power_off_();
+
   static const uint8_t LUT_VCOM1[], LUT_WW1[], LUT_BW1[], LUT_WB1[], LUT_BB1[];
 
 #ifdef USE_ESP32
+  // kept in RTC memory to survive deep sleep, copied after each refresh
+  void on_frame_shown_() override;
+
   static uint8_t oldData[];
 
   static uint32_t at_update_;
 #else
-  uint8_t oldData[WIDTH * HEIGHT / 8];
-
   uint32_t at_update_{0};
 #endif
 
   uint32_t full_update_every_{30};
 
-  bool initial_{false}, hibernating_{false};
+  bool initial_{false}, hibernating_{false}, powered_{false},
+      full_update_{false};
 };
 
 }  // namespace waveshare_epaper
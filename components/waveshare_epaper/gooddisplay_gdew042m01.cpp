@@ -48,10 +48,6 @@ const unsigned char GDEW042M01::LUT_BB1_PARTIAL[] = {  // 01 b
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
-int GDEW042M01::get_width_internal() { return WIDTH; }
-
-int GDEW042M01::get_height_internal() { return HEIGHT; }
-
 uint32_t GDEW042M01::idle_timeout_() { return IDLE_TIMEOUT; }
 
 void GDEW042M01::set_full_update_every(uint32_t full_update_every) {
@@ -60,81 +56,73 @@ void GDEW042M01::set_full_update_every(uint32_t full_update_every) {
 
 void GDEW042M01::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
-void GDEW042M01::initialize() {}
+void GDEW042M01::initialize() {
+  this->init_previous_(&this->at_update_);
+}
 
-void GDEW042M01::display() {
-  bool full_update = this->at_update_ == 0;
+bool GDEW042M01::prepare_display_() {
+  this->full_update_ = this->at_update_ == 0;
+  if (!this->full_update_ && !this->trim_dirty_()) {
+    ESP_LOGD(TAG, "Frame unchanged, skipping partial refresh");
+    return false;
+  }
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
+  return true;
+}
 
-  if (full_update) {
-    this->command(0x10);  // Transfer old data
-    for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-      this->data(0xff);
-    }
+bool GDEW042M01::transfer_display_() {
+  if (this->full_update_) {
+    // Transfer old data
+    this->fill_ram_(0x10, 0xff, this->get_buffer_length_());
 
     this->command(0x13);  // Transfer new data
     this->start_data_();
-    for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-      this->write_byte(this->buffer_[i]);
-      this->oldData[i] = this->buffer_[i];
-    }
+    this->write_plane_(this->buffer_, this->get_buffer_length_());
     this->end_data_();
   } else {
     this->init_part_();
 
-    uint32_t xe = (WIDTH - 1) | 0x0007;
-
-    this->command(0x91);
-    this->command(0x90);  // partial window
-    this->data(0x00);
-    this->data(0x00);
-    this->data(xe / 256);
-    this->data(xe % 256);
-    this->data(0x00);
-    this->data(0x00);
-    this->data((HEIGHT - 1) / 256);
-    this->data((HEIGHT - 1) % 256);
-    this->data(0x01);
+    // only the changed region is sent, x is byte aligned by trim_dirty_()
+    this->queue_command_(0x91);  // partial in
+    this->queue_command_(0x90,   // partial window
+                         this->dirty_x1_ / 256, this->dirty_x1_ % 256,
+                         this->dirty_x2_ / 256, this->dirty_x2_ % 256,
+                         this->dirty_y1_ / 256, this->dirty_y1_ % 256,
+                         this->dirty_y2_ / 256, this->dirty_y2_ % 256, 0x01);
 
     this->command(0x10);  // Transfer old data
     this->start_data_();
-    this->write_array(
-        this->oldData,
-        this->get_buffer_length_());  // Transfer the actual displayed data
+    this->write_previous_window_();  // the actual displayed data
     this->end_data_();
 
     this->command(0x13);  // Transfer new data
     this->start_data_();
-    this->write_array(
-        this->buffer_,
-        this->get_buffer_length_());  // Transfer the actual displayed data
+    this->write_dirty_window_(this->buffer_);
     this->end_data_();
-    for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-      this->oldData[i] = this->buffer_[i];
 
     this->command(0x92);
   }
 
   this->command(0x12);  // DISPLAY REFRESH
   delay(1);             //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
+  return true;
+}
 
-  if (!full_update) {
+void GDEW042M01::finish_display_() {
+  if (!this->full_update_) {
     this->command(0x92);
   }
 
-  this->status_clear_warning();
-
+  if (this->defer_deep_sleep_()) {
+    this->power_off_();
+    return;
+  }
   this->deep_sleep();
 }
 
@@ -146,24 +134,19 @@ void GDEW042M01::init_display_() {
 
   if (hibernating_) reset_();
 
-  this->command(0x00);  // panel setting
-  this->data(0x1f);     // LUT from OTP��?KW-BF   KWR-AF  BWROTP 0f BWOTP 1f
-  this->data(0x0D);
-
-  this->command(0x61);  // resolution setting
-  this->data(WIDTH / 256);
-  this->data(WIDTH % 256);
-  this->data(HEIGHT / 256);
-  this->data(HEIGHT % 256);
-
-  this->command(0x04);
+  // panel setting: LUT from OTP  KW-BF   KWR-AF  BWROTP 0f BWOTP 1f
+  this->queue_register_(0x00, this->panel_setting_(0x1f), 0x0D);
+  this->queue_register_(0x61,  // resolution setting
+                        WIDTH / 256, WIDTH % 256, HEIGHT / 256, HEIGHT % 256);
+  this->queue_command_(0x04);     // power on
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
     return;
+  powered_ = true;
 
-  this->command(0X50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0x97);  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW
-                     // 77 VBDB 37  VBDR B7
+  // VCOM AND DATA INTERVAL SETTING
+  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  this->queue_register_(0X50, 0x97);
 }
 
 void GDEW042M01::reset_() {
@@ -176,42 +159,31 @@ void GDEW042M01::reset_() {
     }
   }
 
+  // registers are back at their defaults
+  this->clear_shadow_();
   hibernating_ = false;
+  powered_ = false;
 }
 
 void GDEW042M01::init_part_() {
-  this->command(0x01);  // POWER SETTING
-  this->data(0x03);     // VDS_EN, VDG_EN internal
-  this->data(0x00);     // VCOM_HV, VGHL_LV=16V
-  this->data(0x2b);     // VDH=11V
-  this->data(0x2b);     // VDL=11V
-
-  this->command(0x06);  // boost soft start
-  this->data(0x17);     // A
-  this->data(0x17);     // B
-  this->data(0x17);     // C
-
-  this->command(0x00);  // panel setting
-  this->data(0x3f);     // 300x400 B/W mode, LUT set by register
-
-  this->command(0x30);  // PLL setting
-  this->data(0x3a);     // 3a 100HZ   29 150Hz 39 200HZ 31 171HZ
-
-  this->command(0x61);  // resolution setting
-  this->data(WIDTH / 256);
-  this->data(WIDTH % 256);
-  this->data(HEIGHT / 256);
-  this->data(HEIGHT % 256);
-
-  this->command(0x82);  // vcom_DC setting
-  this->data(0x1A);     // -0.1 + 26 * -0.05 = -1.4V from OTP
-
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0xd7);     // border floating to avoid flashing
+  // POWER SETTING: VDS_EN, VDG_EN internal; VCOM_HV, VGHL_LV=16V; VDH=11V;
+  // VDL=11V
+  this->queue_register_(0x01, 0x03, 0x00, 0x2b, 0x2b);
+  this->queue_register_(0x06, 0x17, 0x17, 0x17);  // boost soft start A, B, C
+  // panel setting: 300x400 B/W mode, LUT set by register
+  this->queue_register_(0x00, this->panel_setting_(0x3f));
+  // PLL setting: 3a 100HZ   29 150Hz 39 200HZ 31 171HZ
+  this->queue_register_(0x30, 0x3a);
+  this->queue_register_(0x61,  // resolution setting
+                        WIDTH / 256, WIDTH % 256, HEIGHT / 256, HEIGHT % 256);
+  // vcom_DC setting: -0.1 + 26 * -0.05 = -1.4V from OTP
+  this->queue_register_(0x82, 0x1A);
+  // VCOM AND DATA INTERVAL SETTING: border floating to avoid flashing
+  this->queue_register_(0x50, 0xd7);
 
   write_lut_();
 
-  this->command(0x04);
+  this->queue_command_(0x04);  // power on
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
   {
@@ -221,43 +193,32 @@ void GDEW042M01::init_part_() {
 }
 
 void GDEW042M01::write_lut_() {
-  this->command(0x20);
-  for (uint8_t count = 0; count < 44; count++) {
-    this->data(LUT_VCOM1_PARTIAL[count]);
-  }
-
-  this->command(0x21);
-  for (uint8_t count = 0; count < 42; count++) {
-    this->data(LUT_WW1_PARTIAL[count]);
-  }
+  this->write_register_(0x20, LUT_VCOM1_PARTIAL, sizeof(LUT_VCOM1_PARTIAL));
+  this->write_register_(0x21, LUT_WW1_PARTIAL, sizeof(LUT_WW1_PARTIAL));
+  this->write_register_(0x22, LUT_BW1_PARTIAL, sizeof(LUT_BW1_PARTIAL));
+  this->write_register_(0x23, LUT_WB1_PARTIAL, sizeof(LUT_WB1_PARTIAL));
+  this->write_register_(0x24, LUT_BB1_PARTIAL, sizeof(LUT_BB1_PARTIAL));
+}
 
-  this->command(0x22);
-  for (uint8_t count = 0; count < 42; count++) {
-    this->data(LUT_BW1_PARTIAL[count]);
-  }
+// Registers and LUTs are kept while powered off, only deep sleep loses them.
+bool GDEW042M01::power_off_() {
+  if (!powered_) return true;
 
-  this->command(0x23);
-  for (uint8_t count = 0; count < 42; count++) {
-    this->data(LUT_WB1_PARTIAL[count]);
-  }
-
-  this->command(0x24);
-  for (uint8_t count = 0; count < 42; count++) {
-    this->data(LUT_BB1_PARTIAL[count]);
-  }
+  this->queue_command_(0x02);     // power off
+  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
+                                  // release the idle signal
+    return false;
+  powered_ = false;
+  return true;
 }
 
 void GDEW042M01::deep_sleep() {
   if (hibernating_) return;
 
-  this->command(0x02);            // power off
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-    return;
+  if (!this->power_off_()) return;
 
-  delay(100);           //!!!The delay here is necessary,100mS at least!!!
-  this->command(0x07);  // deep sleep
-  this->data(0xA5);
+  delay(100);  //!!!The delay here is necessary,100mS at least!!!
+  this->queue_command_(0x07, 0xA5);  // deep sleep
   hibernating_ = true;
 }
 
@@ -269,6 +230,9 @@ void GDEW042M01::dump_config() {
   LOG_PIN("  DC Pin: ", this->dc_pin_)
   LOG_PIN("  Busy Pin: ", this->busy_pin_)
   LOG_UPDATE_INTERVAL(this);
+  if (this->standby_timeout_ != 0)
+    ESP_LOGCONFIG(TAG, "  Standby Timeout: %" PRIu32 " ms",
+                  this->standby_timeout_);
 }
 
 }  // namespace waveshare_epaper
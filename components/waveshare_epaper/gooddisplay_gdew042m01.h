@@ -3,22 +3,16 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class GDEW042M01 : public WaveshareEPaper {
+class GDEW042M01 : public FixedGeometry<WaveshareEPaper, 400, 300> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 400;
-
-  static const uint16_t HEIGHT = 300;
-
   static const uint16_t IDLE_TIMEOUT = 40000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
@@ -26,14 +20,18 @@ class GDEW042M01 : public WaveshareEPaper {
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
+
+  bool transfer_display_() override;
 
-  int get_height_internal() override;
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
   bool is_busy_pin_inverted_() override { return true; }
 
+  bool can_flip_scan_() override { return true; }
+
   void init_display_();
 
   void init_part_();
@@ -42,14 +40,15 @@ class GDEW042M01 : public WaveshareEPaper {
 
   void write_lut_();
 
+  bool power_off_();
+
   static const uint8_t LUT_VCOM1_PARTIAL[], LUT_WW1_PARTIAL[],
       LUT_BW1_PARTIAL[], LUT_WB1_PARTIAL[], LUT_BB1_PARTIAL[];
 
-  uint8_t oldData[WIDTH * HEIGHT / 8];
-
   uint32_t at_update_{0}, full_update_every_{30};
 
-  bool initial_{false}, hibernating_{false};
+  bool initial_{false}, hibernating_{false}, powered_{false},
+      full_update_{false};
 };
 
 }  // namespace waveshare_epaper
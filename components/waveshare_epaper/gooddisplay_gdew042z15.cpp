@@ -11,47 +11,54 @@ namespace waveshare_epaper {
 
 const char *const GDEW042Z15::TAG = "gdew042z15";
 
-int GDEW042Z15::get_width_internal() { return WIDTH; }
-
-int GDEW042Z15::get_height_internal() { return HEIGHT; }
-
 uint32_t GDEW042Z15::idle_timeout_() { return IDLE_TIMEOUT; }
 
-void GDEW042Z15::full_refresh() { this->update(); }
+void GDEW042Z15::full_refresh() {
+  this->force_update_ = true;
+  this->update();
+}
 
 void GDEW042Z15::initialize() {}
 
-void GDEW042Z15::display() {
-  uint32_t buf_len_half = this->get_buffer_length_() >> 1;
+bool GDEW042Z15::prepare_display_() {
   this->init_display_();
+  return true;
+}
+
+void GDEW042Z15::write_band_(int y, int rows) {
+  const uint32_t length = rows * this->buffer_stride_();
+  if (this->paged_()) {
+    // partial window for the RAM writes only, left before the refresh
+    const uint16_t y2 = y + rows - 1;
+    this->queue_command_(0x91);
+    this->queue_command_(0x90, 0x00, 0x00, (WIDTH - 1) / 256,
+                         (WIDTH - 1) % 256, y / 256, y % 256, y2 / 256,
+                         y2 % 256, 0x01);
+  }
 
   // Write black Data
   this->command(0x10);
   this->start_data_();
-  this->write_array(this->buffer_, buf_len_half);
+  this->write_plane_(this->buffer_, length);
   this->end_data_();
 
   // Write red Data
   this->command(0x13);
   this->start_data_();
-  for (uint32_t i = buf_len_half; i < buf_len_half * 2u; i++)
-    this->write_byte(~this->buffer_[i]);
+  this->write_plane_(this->buffer_ + this->plane_length_(), length, true);
   this->end_data_();
 
+  if (this->paged_()) this->queue_command_(0x92);
+}
+
+bool GDEW042Z15::trigger_refresh_() {
   this->command(0x12);  // DISPLAY REFRESH
   delay(100);           //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
-
-  this->status_clear_warning();
-
-  this->deep_sleep();
+  return true;
 }
 
+void GDEW042Z15::finish_display_() { this->deep_sleep(); }
+
 void GDEW042Z15::init_display_() {
   if (!initial_) {
     reset_();
@@ -60,12 +67,8 @@ void GDEW042Z15::init_display_() {
 
   if (hibernating_) reset_();  // Electronic paper IC reset
 
-  this->command(0x06);  // boost soft start
-  this->data(0x17);     // A
-  this->data(0x17);     // B
-  this->data(0x17);     // C
-
-  this->command(0x04);            // Power on
+  this->queue_command_(0x06, 0x17, 0x17, 0x17);  // boost soft start: A, B, C
+  this->queue_command_(0x04);     // Power on
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
   {
@@ -73,9 +76,8 @@ void GDEW042Z15::init_display_() {
     return;
   }
 
-  this->command(0x00);  // panel setting
-  this->data(0x0f);     // LUT from OTP£¬400x300
-  this->data(0x0d);     // VCOM to 0V fast
+  // panel setting: LUT from OTP£¬400x300, VCOM to 0V fast
+  this->queue_command_(0x00, this->panel_setting_(0x0f), 0x0d);
 }
 
 void GDEW042Z15::reset_() {
@@ -92,18 +94,16 @@ void GDEW042Z15::reset_() {
 void GDEW042Z15::deep_sleep() {
   if (hibernating_) return;
 
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0xf7);     // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7
-                        // VBDW 77 VBDB 37  VBDR B7
-
-  this->command(0x02);            // power off
+  // VCOM AND DATA INTERVAL SETTING
+  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  this->queue_command_(0x50, 0xf7);
+  this->queue_command_(0x02);     // power off
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
     return;
 
   // delay(100);          //!!!The delay here is necessary,100mS at least!!!
-  this->command(0x07);  // deep sleep
-  this->data(0xA5);
+  this->queue_command_(0x07, 0xA5);  // deep sleep
   hibernating_ = true;
 }
 
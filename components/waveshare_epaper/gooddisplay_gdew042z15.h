@@ -3,35 +3,35 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class GDEW042Z15 : public WaveshareEPaperBWR {
+class GDEW042Z15 : public FixedGeometry<WaveshareEPaperBWR, 400, 300> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 400;
-
-  static const uint16_t HEIGHT = 300;
-
   static const uint16_t IDLE_TIMEOUT = 45000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
 
-  int get_height_internal() override;
+  void write_band_(int y, int rows) override;
+
+  bool trigger_refresh_() override;
+
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
   bool is_busy_pin_inverted_() override { return true; }
 
+  bool can_flip_scan_() override { return true; }
+
   void init_display_();
 
   void reset_();
@@ -3,22 +3,16 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class GDEY029Z95 : public WaveshareEPaperBWR {
+class GDEY029Z95 : public FixedGeometry<WaveshareEPaperBWR, 128, 296> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 128;
-
-  static const uint16_t HEIGHT = 296;
-
   static const uint16_t IDLE_TIMEOUT = 16000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
@@ -26,14 +20,20 @@ class GDEY029Z95 : public WaveshareEPaperBWR {
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
+
+  void write_band_(int y, int rows) override;
 
-  int get_height_internal() override;
+  bool trigger_refresh_() override;
+
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
   void init_display_();
 
+  static const uint8_t INIT_SEQUENCE[];
+
   void reset_();
 
 #ifdef USE_ESP32
@@ -44,6 +44,8 @@ class GDEY029Z95 : public WaveshareEPaperBWR {
 
   uint32_t full_update_every_{30};
 
+  RefreshMode mode_{FULL_REFRESH};
+
   bool initial_{false}, hibernating_{false};
 };
 
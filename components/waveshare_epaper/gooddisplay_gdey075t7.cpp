@@ -9,9 +9,17 @@ namespace waveshare_epaper {
 
 const char *const GDEY075T7::TAG = "gdey075t7";
 
-int GDEY075T7::get_width_internal() { return WIDTH; }
-
-int GDEY075T7::get_height_internal() { return HEIGHT; }
+const uint8_t GDEY075T7::INIT_SEQUENCE[] = {
+    // POWER SETTING: VGH=20V,VGL=-20V, VDH=15V, VDL=-15V
+    0x01, 4, 0x07, 0x07, 0x3f, 0x3f,
+    // Enhanced display drive(Add 0x06 command): Booster Soft Start
+    0x06, 4, 0x17, 0x17, 0x28, 0x17,
+    0x04, SEQ_DELAY | SEQ_WAIT, 100,  // POWER ON
+    0x61, 4, 0x03, 0x20, 0x01, 0xE0,  // tres: 800 x 480
+    0x15, 1, 0x00,
+    0x50, 2, 0x10, 0x07,  // VCOM AND DATA INTERVAL SETTING
+    0x60, 1, 0x22,        // TCON SETTING
+};
 
 uint32_t GDEY075T7::idle_timeout_() { return IDLE_TIMEOUT; }
 
@@ -21,201 +29,141 @@ void GDEY075T7::set_full_update_every(uint32_t full_update_every) {
 
 void GDEY075T7::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
-void GDEY075T7::initialize() {}
+void GDEY075T7::initialize() {
+  this->init_previous_(&this->at_update_);
+}
 
-void GDEY075T7::display() {
-  RefreshMode mode = this->at_update_ == 0 ? FULL_REFRESH : PARTIAL_REFRESH;
+bool GDEY075T7::prepare_display_() {
+  this->mode_ = this->at_update_ == 0 ? FULL_REFRESH : PARTIAL_REFRESH;
+  if (this->mode_ == PARTIAL_REFRESH && !this->trim_dirty_()) {
+    ESP_LOGD(TAG, "Frame unchanged, skipping partial refresh");
+    return false;
+  }
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
+  return true;
+}
 
-  this->write_buffer_(mode);
-
-  this->status_clear_warning();
+bool GDEY075T7::transfer_display_() { return this->write_buffer_(this->mode_); }
 
-  this->deep_sleep();
-}
+void GDEY075T7::finish_display_() { this->deep_sleep(); }
 
 void GDEY075T7::init_display_() {
   reset_();
 
   this->wait_until_idle_();
 
-  this->command(0x01);  // POWER SETTING
-  this->data(0x07);
-  this->data(0x07);  // VGH=20V,VGL=-20V
-  this->data(0x3f);  // VDH=15V
-  this->data(0x3f);  // VDL=-15V
-
-  // Enhanced display drive(Add 0x06 command)
-  this->command(0x06);  // Booster Soft Start
-  this->data(0x17);
-  this->data(0x17);
-  this->data(0x28);
-  this->data(0x17);
-
-  this->command(0x04);  // POWER ON
-  delay(100);
-  this->wait_until_idle_();  // waiting for the electronic paper IC to
-                             // release the idle signal
-
-  this->command(0x00);  // PANNEL SETTING
-  this->data(0x1F);     // KW-3f   KWR-2F BWROTP 0f BWOTP 1f
-
-  this->command(0x61);  // tres
-  this->data(0x03);     // source 800
-  this->data(0x20);
-  this->data(0x01);  // gate 480
-  this->data(0xE0);
-
-  this->command(0x15);
-  this->data(0x00);
-
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0x10);
-  this->data(0x07);
-
-  this->command(0x60);  // TCON SETTING
-  this->data(0x22);
+  this->run_sequence_(INIT_SEQUENCE, sizeof(INIT_SEQUENCE));
+  // PANNEL SETTING: KW-3f   KWR-2F BWROTP 0f BWOTP 1f
+  this->queue_command_(0x00, this->panel_setting_(0x1F));
 }
 
-void GDEY075T7::write_buffer_(RefreshMode mode) {
+bool GDEY075T7::write_buffer_(RefreshMode mode) {
   switch (mode) {
     case FULL_REFRESH:
-      this->clear_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-        oldData_[i] = 0xff;
+      if (this->anti_ghosting_) {
+        // blank the panel, then draw the frame with a partial update; the
+        // blanking refresh is waited for here, also with async_refresh
+        if (!this->clear_()) return false;
+        this->clear_previous_();
+        this->mark_all_dirty_();
+        return this->write_buffer_(PARTIAL_REFRESH);
       }
-      this->write_buffer_(PARTIAL_REFRESH);
-      return;
 
-    case FAST_REFRESH:
-      this->command(0x00);  // PANNEL SETTING
-      this->data(0x1F);     // KW-3f   KWR-2F BWROTP 0f BWOTP 1f
+      // single full waveform, data polarity as set by init_display_()
+      this->fill_ram_(0x10, 0x00, this->get_buffer_length_());
 
-      this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-      this->data(0x10);
-      this->data(0x07);
+      this->command(0x13);  // writes New data to SRAM.
+      this->start_data_();
+      this->write_plane_(this->buffer_, this->get_buffer_length_(), true);
+      this->end_data_();
+      break;
 
-      this->command(0x04);  // POWER ON
+    case FAST_REFRESH:
+      // PANNEL SETTING: KW-3f   KWR-2F BWROTP 0f BWOTP 1f
+      this->queue_command_(0x00, this->panel_setting_(0x1F));
+      // VCOM AND DATA INTERVAL SETTING
+      this->queue_command_(0x50, 0x10, 0x07);
+      this->queue_command_(0x04);  // POWER ON
+      this->flush_commands_();
       delay(100);
       this->wait_until_idle_();  // waiting for the electronic paper IC to
                                  // release the idle signal
 
-      // Enhanced display drive(Add 0x06 command)
-      this->command(0x06);  // Booster Soft Start
-      this->data(0x27);
-      this->data(0x27);
-      this->data(0x18);
-      this->data(0x17);
-
-      this->command(0xE0);
-      this->data(0x02);
-      this->command(0xE5);
-      this->data(0x5A);
+      // Enhanced display drive(Add 0x06 command): Booster Soft Start
+      this->queue_command_(0x06, 0x27, 0x27, 0x18, 0x17);
+      this->queue_command_(0xE0, 0x02);  // cascade setting
+      this->queue_command_(0xE5, 0x5A);  // force temperature
 
       // Write old Data
-      this->command(0x10);
-      this->start_data_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-        this->write_byte(0x00);
-      this->end_data_();
+      this->fill_ram_(0x10, 0x00, this->get_buffer_length_());
 
       // Write new Data
       this->command(0x13);  // writes New data to SRAM.
       this->start_data_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++) {
-        this->write_byte(~this->buffer_[i]);
-        oldData_[i] = this->buffer_[i];
-      }
+      this->write_plane_(this->buffer_, this->get_buffer_length_(), true);
       this->end_data_();
       break;
 
     case PARTIAL_REFRESH:
-      this->command(0x00);  // PANNEL SETTING
-      this->data(0x1F);     // KW-3f   KWR-2F BWROTP 0f BWOTP 1f
-
-      this->command(0x04);  // POWER ON
+      // PANNEL SETTING: KW-3f   KWR-2F BWROTP 0f BWOTP 1f
+      this->queue_command_(0x00, this->panel_setting_(0x1F));
+      this->queue_command_(0x04);  // POWER ON
+      this->flush_commands_();
       delay(100);
       this->wait_until_idle_();  // waiting for the electronic paper IC to
                                  // release the idle signal
-      this->command(0xE0);
-      this->data(0x02);
-      this->command(0xE5);
-      this->data(0x6E);
-
-      this->command(0x50);
-      this->data(0xA9);
-      this->data(0x07);
-
-      this->command(0x91);  // This command makes the display enter partial mode
-      this->command(0x90);  // resolution setting
-      this->data(0x00);
-      this->data(0x00);  // x-start
-      this->data(WIDTH / 256);
-      this->data(WIDTH % 256 - 1);  // x-end
-      this->data(0x00);             //
-      this->data(0x00);             // y-start
-      this->data(HEIGHT / 256);
-      this->data(HEIGHT % 256 - 1);  // y-end
-      this->data(0x01);
+      this->queue_command_(0xE0, 0x02);  // cascade setting
+      this->queue_command_(0xE5, 0x6E);  // force temperature
+      this->queue_command_(0x50, 0xA9, 0x07);
+
+      // enter partial mode with the partial window, x is byte aligned
+      this->queue_command_(0x91);
+      this->queue_command_(0x90,
+                           this->dirty_x1_ / 256, this->dirty_x1_ % 256,  // x
+                           this->dirty_x2_ / 256, this->dirty_x2_ % 256,
+                           this->dirty_y1_ / 256, this->dirty_y1_ % 256,  // y
+                           this->dirty_y2_ / 256, this->dirty_y2_ % 256, 0x01);
 
       this->command(0x10);
       this->start_data_();
-      this->write_array(this->oldData_, this->get_buffer_length_());
+      this->write_previous_window_();
       this->end_data_();
 
       this->command(0x13);  // writes New data to SRAM.
       this->start_data_();
-      this->write_array(this->buffer_, this->get_buffer_length_());
+      this->write_dirty_window_(this->buffer_);
       this->end_data_();
-      for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-        oldData_[i] = this->buffer_[i];
 
       this->command(0x92);
       break;
 
     default:
       ESP_LOGE(TAG, "unsupported refresh mode, mode:%d", mode);
-      return;
+      return false;
   }
 
   this->command(0x12);  // DISPLAY update
   delay(1);             //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
+  return true;
 }
 
-void GDEY075T7::clear_() {
+bool GDEY075T7::clear_() {
   // Write old Data
-  this->command(0x10);
-  this->start_data_();
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0x00);
-  this->end_data_();
+  this->fill_ram_(0x10, 0x00, this->get_buffer_length_());
 
   // Write new Data
-  this->command(0x13);
-  this->start_data_();
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-    this->write_byte(0x00);
-  this->end_data_();
+  this->fill_ram_(0x13, 0x00, this->get_buffer_length_());
 
   this->command(0x12);  // DISPLAY update
   delay(1);             //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
+  return this->wait_until_idle_();  // waiting for the electronic paper IC to
+                                    // release the idle signal
 }
 
 void GDEY075T7::reset_() {
@@ -228,17 +176,15 @@ void GDEY075T7::reset_() {
 }
 
 void GDEY075T7::deep_sleep() {
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0xf7);     // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7
-                        // VBDW 77 VBDB 37  VBDR B7
-
-  this->command(0x02);            // power off
+  // VCOM AND DATA INTERVAL SETTING
+  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  this->queue_command_(0x50, 0xf7);
+  this->queue_command_(0x02);     // power off
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
     return;
 
-  this->command(0x07);  // deep sleep
-  this->data(0xA5);
+  this->queue_command_(0x07, 0xA5);  // deep sleep
 }
 
 void GDEY075T7::dump_config() {
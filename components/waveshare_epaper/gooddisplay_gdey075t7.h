@@ -3,48 +3,54 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class GDEY075T7 : public WaveshareEPaper {
+class GDEY075T7 : public FixedGeometry<WaveshareEPaper, 800, 480> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 800;
-
-  static const uint16_t HEIGHT = 480;
-
   static const uint16_t IDLE_TIMEOUT = 6000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
 
+  void set_anti_ghosting(bool anti_ghosting) {
+    this->anti_ghosting_ = anti_ghosting;
+  }
+
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
+
+  bool transfer_display_() override;
 
-  int get_height_internal() override;
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
   bool is_busy_pin_inverted_() override { return true; }
 
+  bool can_flip_scan_() override { return true; }
+
   void init_display_();
 
-  void write_buffer_(RefreshMode mode);
+  static const uint8_t INIT_SEQUENCE[];
 
-  void clear_();
+  bool write_buffer_(RefreshMode mode);
 
-  void reset_();
+  bool clear_();
 
-  uint8_t oldData_[WIDTH * HEIGHT / 8];
+  void reset_();
 
   uint32_t at_update_{0}, full_update_every_{30};
+
+  bool anti_ghosting_{false};
+
+  RefreshMode mode_{FULL_REFRESH};
 };
 
 }  // namespace waveshare_epaper
@@ -45,9 +45,19 @@ const uint8_t E0213A09::LUT_DATA_PART[] = {
 RTC_DATA_ATTR uint32_t E0213A09::at_update_ = 0;
 #endif
 
-int E0213A09::get_width_internal() { return WIDTH; }
-
-int E0213A09::get_height_internal() { return HEIGHT; }
+const uint8_t E0213A09::INIT_SEQUENCE[] = {
+    0x74, 1, 0x54,  // set analog block control
+    0x7E, 1, 0x3B,  // set digital block control
+    0x01, 3, (HEIGHT - 1) % 256, (HEIGHT - 1) / 256,
+    0x00,           // Driver output control
+    0x3C, 1, 0x03,  // BorderWavefrom
+    0x2C, 1, 0x70,  // VCOM Voltage: NA ??
+    0x03, 1, 0x15,  // Gate Driving voltage Control: 19V
+    // Source Driving voltage Control: VSH1 15V, VSH2 5V, VSL -15V
+    0x04, 3, 0x41, 0xA8, 0x32,
+    0x3A, 1, 0x30,  // Dummy Line
+    0x3B, 1, 0x0A,  // Gate time
+};
 
 uint32_t E0213A09::idle_timeout_() { return IDLE_TIMEOUT; }
 
@@ -57,6 +67,7 @@ void E0213A09::set_full_update_every(uint32_t full_update_every) {
 
 void E0213A09::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
@@ -67,48 +78,45 @@ void E0213A09::initialize() {
 #endif
 }
 
-void E0213A09::display() {
-  bool full_update = this->at_update_ == 0;
+bool E0213A09::prepare_display_() {
+  this->full_update_ = this->at_update_ == 0;
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
   this->init_display_();
-  if (full_update) {
+  return true;
+}
+
+bool E0213A09::transfer_display_() {
+  if (this->full_update_) {
     this->cmd_data(0x32, LUT_DATA_FULL, sizeof(LUT_DATA_FULL));
   } else {
-    this->command(0x2C);  // VCOM Voltage
-    this->data(0x26);     // NA ??
+    this->queue_command_(0x2C, 0x26);  // VCOM Voltage: NA ??
     this->cmd_data(0x32, LUT_DATA_PART, sizeof(LUT_DATA_PART));
   }
-  this->command(0x22);
-  this->data(0xc0);
-  this->command(0x20);
+  this->queue_command_(0x22, 0xc0);
+  this->queue_command_(0x20);
   if (!this->wait_until_idle_()) {
-    this->status_set_warning();
-    return;
+    return false;
   }
 
   this->setPartialRamArea_(0, 0, WIDTH, HEIGHT);
   this->command(0x24);
   this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
+  this->write_plane_(this->buffer_, this->get_buffer_length_());
   this->end_data_();
 
-  this->command(0x22);
-  this->data(full_update ? 0xC4 : 0x04);
-  this->command(0x20);
-  if (!this->wait_until_idle_()) {
-    this->status_set_warning();
-    return;
-  }
+  this->queue_command_(0x22, this->full_update_ ? 0xC4 : 0x04);
+  this->queue_command_(0x20);
+  return true;
+}
 
+void E0213A09::finish_display_() {
   this->setPartialRamArea_(0, 0, WIDTH, HEIGHT);
   this->command(0x26);
   this->start_data_();
-  this->write_array(this->buffer_, this->get_buffer_length_());
+  this->write_plane_(this->buffer_, this->get_buffer_length_());
   this->end_data_();
 
-  this->status_clear_warning();
-
   this->deep_sleep();
 }
 
@@ -120,36 +128,7 @@ void E0213A09::init_display_() {
 
   if (hibernating_) reset_();
 
-  this->command(0x74);  // set analog block control
-  this->data(0x54);
-
-  this->command(0x7E);  // set digital block control
-  this->data(0x3B);
-
-  this->command(0x01);            // Driver output control
-  this->data(HEIGHT - 1);         // (HEIGHT - 1) % 256
-  this->data((HEIGHT - 1) >> 8);  // (HEIGHT - 1) / 256
-  this->data(0x00);
-
-  this->command(0x3C);  // BorderWavefrom
-  this->data(0x03);
-
-  this->command(0x2C);  // VCOM Voltage
-  this->data(0x70);     // NA ??
-
-  this->command(0x03);  // Gate Driving voltage Control
-  this->data(0x15);     // 19V
-
-  this->command(0x04);  // Source Driving voltage Control
-  this->data(0x41);     // VSH1 15V
-  this->data(0xA8);     // VSH2 5V
-  this->data(0x32);     // VSL -15V
-
-  this->command(0x3A);  // Dummy Line
-  this->data(0x30);
-
-  this->command(0x3B);  // Gate time
-  this->data(0x0A);
+  this->run_sequence_(INIT_SEQUENCE, sizeof(INIT_SEQUENCE));
   this->setPartialRamArea_(0, 0, WIDTH, HEIGHT);
 }
 
@@ -166,38 +145,24 @@ void E0213A09::reset_() {
 
 void E0213A09::setPartialRamArea_(uint16_t x, uint16_t y, uint16_t w,
                                   uint16_t h) {
-  this->command(0x11);  // set ram entry mode
-  this->data(0x03);     // x increase, y increase : normal mode
-
-  this->command(0x44);
-  this->data(x / 8);
-  this->data((x + w - 1) / 8);
-
-  this->command(0x45);
-  this->data(y % 256);
-  this->data(y / 256);
-  this->data((y + h - 1) % 256);
-  this->data((y + h - 1) / 256);
-
-  this->command(0x4e);
-  this->data(x / 8);
-
-  this->command(0x4f);
-  this->data(y % 256);
-  this->data(y / 256);
+  // set ram entry mode: x increase, y increase : normal mode
+  this->queue_command_(0x11, 0x03);
+  this->queue_command_(0x44, x / 8, (x + w - 1) / 8);
+  this->queue_command_(0x45, y % 256, y / 256, (y + h - 1) % 256,
+                       (y + h - 1) / 256);
+  this->queue_command_(0x4e, x / 8);
+  this->queue_command_(0x4f, y % 256, y / 256);
 }
 
 void E0213A09::deep_sleep() {
   if (hibernating_) return;
 
   // power off
-  this->command(0x22);
-  this->data(0xc3);
-  this->command(0x20);
+  this->queue_command_(0x22, 0xc3);
+  this->queue_command_(0x20);
 
   if (this->reset_pin_ != nullptr) {
-    this->command(0x10);  // deep sleep mode
-    this->data(0x1);      // enter deep sleep
+    this->queue_command_(0x10, 0x01);  // deep sleep mode: enter deep sleep
     hibernating_ = true;
   }
 }
@@ -16,9 +16,27 @@ const char *const P750057MF1A::TAG = "p750057-mf1-a";
 RTC_DATA_ATTR uint32_t P750057MF1A::at_update_ = 0;
 #endif
 
-int P750057MF1A::get_width_internal() { return WIDTH; }
-
-int P750057MF1A::get_height_internal() { return HEIGHT; }
+const uint8_t P750057MF1A::FULL_INIT_SEQUENCE[] = {
+    // POWER SETTING: VGH=20V,VGL=-20V, VDH=15V, VDL=-15V
+    0x01, 4, 0x07, 0x07, 0x3f, 0x3f,
+    // Enhanced display drive(Add 0x06 command): Booster Soft Start
+    0x06, 4, 0x17, 0x17, 0x28, 0x17,
+    0x04, SEQ_WAIT,  // POWER ON
+    0x61, 4, WIDTH / 256, WIDTH % 256, HEIGHT / 256,
+    HEIGHT % 256,  // resolution setting
+    0x15, 1, 0x00,
+    0x50, 2, 0x11, 0x07,  // VCOM AND DATA INTERVAL SETTING
+    0x60, 1, 0x22,        // TCON SETTING
+};
+
+const uint8_t P750057MF1A::FAST_INIT_SEQUENCE[] = {
+    0x04, SEQ_DELAY | SEQ_WAIT, 100,  // POWER ON
+    // Enhanced display drive(Add 0x06 command): Booster Soft Start
+    0x06, 4, 0x27, 0x27, 0x18, 0x17,
+    0xE0, 1, 0x02,        // cascade setting
+    0xE5, 1, 0x5A,        // force temperature
+    0x50, 2, 0x11, 0x07,  // VCOM AND DATA INTERVAL SETTING
+};
 
 uint32_t P750057MF1A::idle_timeout_() { return IDLE_TIMEOUT; }
 
@@ -28,6 +46,7 @@ void P750057MF1A::set_full_update_every(uint32_t full_update_every) {
 
 void P750057MF1A::full_refresh() {
   this->at_update_ = 0;
+  this->force_update_ = true;
   this->update();
 }
 
@@ -38,40 +57,48 @@ void P750057MF1A::initialize() {
 #endif
 }
 
-void P750057MF1A::display() {
-  bool full_update = this->at_update_ == 0;
+bool P750057MF1A::prepare_display_() {
+  this->full_update_ = this->at_update_ == 0;
   this->at_update_ = (this->at_update_ + 1) % this->full_update_every_;
 
-  this->init_display_(full_update ? FULL_REFRESH : FAST_REFRESH);
+  this->init_display_(this->full_update_ ? FULL_REFRESH : FAST_REFRESH);
+  return true;
+}
 
-  uint32_t buf_len_half = this->get_buffer_length_() >> 1;
+void P750057MF1A::write_band_(int y, int rows) {
+  const uint32_t length = rows * this->buffer_stride_();
+  if (this->paged_()) {
+    // partial window for the RAM writes only, left before the refresh
+    const uint16_t y2 = y + rows - 1;
+    this->queue_command_(0x91);
+    this->queue_command_(0x90, 0x00, 0x00, (WIDTH - 1) / 256,
+                         (WIDTH - 1) % 256, y / 256, y % 256, y2 / 256,
+                         y2 % 256, 0x01);
+  }
 
   // Write black Data
   this->command(0x10);
   this->start_data_();
-  this->write_array(this->buffer_, buf_len_half);
+  this->write_plane_(this->buffer_, length);
   this->end_data_();
 
   // Write red Data
   this->command(0x13);
   this->start_data_();
-  this->write_array(this->buffer_ + buf_len_half, buf_len_half);
+  this->write_plane_(this->buffer_ + this->plane_length_(), length);
   this->end_data_();
 
+  if (this->paged_()) this->queue_command_(0x92);
+}
+
+bool P750057MF1A::trigger_refresh_() {
   this->command(0x12);  // DISPLAY REFRESH
   delay(100);           //!!!The delay here is necessary, 200uS at least!!!
-  if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
-                                  // release the idle signal
-  {
-    this->status_set_warning();
-    return;
-  }
-
-  this->status_clear_warning();
-
-  this->deep_sleep();
+  return true;
 }
 
+void P750057MF1A::finish_display_() { this->deep_sleep(); }
+
 // Fast update 1 initialization
 void P750057MF1A::init_display_(RefreshMode mode) {
   if (!initial_) {
@@ -84,65 +111,13 @@ void P750057MF1A::init_display_(RefreshMode mode) {
   this->wait_until_idle_();
 
   if (mode == FULL_REFRESH) {
-    this->command(0x01);  // POWER SETTING
-    this->data(0x07);
-    this->data(0x07);  // VGH=20V,VGL=-20V
-    this->data(0x3f);  // VDH=15V
-    this->data(0x3f);  // VDL=-15V
-
-    // Enhanced display drive(Add 0x06 command)
-    this->command(0x06);  // Booster Soft Start
-    this->data(0x17);
-    this->data(0x17);
-    this->data(0x28);
-    this->data(0x17);
-
-    this->command(0x04);       // POWER ON
-    this->wait_until_idle_();  // waiting for the electronic paper IC to release
-                               // the idle signal
-
-    this->command(0x00);  // PANNEL SETTING
-    this->data(0x0F);     // KW-3f   KWR-2F	BWROTP 0f	BWOTP 1f
-
-    this->command(0x61);  // resolution setting
-    this->data(WIDTH / 256);
-    this->data(WIDTH % 256);
-    this->data(HEIGHT / 256);
-    this->data(HEIGHT % 256);
-
-    this->command(0x15);
-    this->data(0x00);
-
-    this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-    this->data(0x11);     // 0x10  --------------
-    this->data(0x07);
-
-    this->command(0x60);  // TCON SETTING
-    this->data(0x22);
+    this->run_sequence_(FULL_INIT_SEQUENCE, sizeof(FULL_INIT_SEQUENCE));
+    // PANNEL SETTING: KW-3f   KWR-2F	BWROTP 0f	BWOTP 1f
+    this->queue_command_(0x00, this->panel_setting_(0x0F));
   } else if (mode == FAST_REFRESH) {
-    this->command(0x00);  // PANNEL SETTING
-    this->data(0x0F);     // KW-3f   KWR-2F	BWROTP 0f	BWOTP 1f
-
-    this->command(0x04);  // POWER ON
-    delay(100);
-    this->wait_until_idle_();  // waiting for the electronic paper IC to release
-                               // the idle signal
-
-    // Enhanced display drive(Add 0x06 command)
-    this->command(0x06);  // Booster Soft Start
-    this->data(0x27);
-    this->data(0x27);
-    this->data(0x18);
-    this->data(0x17);
-
-    this->command(0xE0);
-    this->data(0x02);
-    this->command(0xE5);
-    this->data(0x5A);
-
-    this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-    this->data(0x11);
-    this->data(0x07);
+    // PANNEL SETTING: KW-3f   KWR-2F	BWROTP 0f	BWOTP 1f
+    this->queue_command_(0x00, this->panel_setting_(0x0F));
+    this->run_sequence_(FAST_INIT_SEQUENCE, sizeof(FAST_INIT_SEQUENCE));
   }
 }
 
@@ -160,18 +135,16 @@ void P750057MF1A::reset_() {
 void P750057MF1A::deep_sleep() {
   if (hibernating_) return;
 
-  this->command(0x50);  // VCOM AND DATA INTERVAL SETTING
-  this->data(0xf7);     // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7
-                        // VBDW 77 VBDB 37  VBDR B7
-
-  this->command(0x02);            // power off
+  // VCOM AND DATA INTERVAL SETTING
+  // WBmode:VBDF 17|D7 VBDW 97 VBDB 57    WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  this->queue_command_(0x50, 0xf7);
+  this->queue_command_(0x02);     // power off
   if (!this->wait_until_idle_())  // waiting for the electronic paper IC to
                                   // release the idle signal
     return;
 
   // delay(100);          //!!!The delay here is necessary,100mS at least!!!
-  this->command(0x07);  // deep sleep
-  this->data(0xA5);
+  this->queue_command_(0x07, 0xA5);  // deep sleep
   hibernating_ = true;
 }
 
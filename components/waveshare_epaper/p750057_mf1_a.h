@@ -3,22 +3,16 @@
 namespace esphome {
 namespace waveshare_epaper {
 
-class P750057MF1A : public WaveshareEPaperBWR {
+class P750057MF1A : public FixedGeometry<WaveshareEPaperBWR, 800, 480> {
  public:
   static const char *const TAG;
 
-  static const uint16_t WIDTH = 800;
-
-  static const uint16_t HEIGHT = 480;
-
   static const uint16_t IDLE_TIMEOUT = 26000;
 
   void initialize() override;
 
   void dump_config() override;
 
-  void display() override;
-
   void deep_sleep() override;
 
   void set_full_update_every(uint32_t full_update_every);
@@ -26,16 +20,24 @@ class P750057MF1A : public WaveshareEPaperBWR {
   void full_refresh();
 
  protected:
-  int get_width_internal() override;
+  bool prepare_display_() override;
+
+  void write_band_(int y, int rows) override;
 
-  int get_height_internal() override;
+  bool trigger_refresh_() override;
+
+  void finish_display_() override;
 
   uint32_t idle_timeout_() override;
 
   bool is_busy_pin_inverted_() override { return true; }
 
+  bool can_flip_scan_() override { return true; }
+
   void init_display_(RefreshMode mode);
 
+  static const uint8_t FULL_INIT_SEQUENCE[], FAST_INIT_SEQUENCE[];
+
   void reset_();
 
 #ifdef USE_ESP32
@@ -46,7 +48,7 @@ class P750057MF1A : public WaveshareEPaperBWR {
 
   uint32_t full_update_every_{30};
 
-  bool initial_{false}, hibernating_{false};
+  bool initial_{false}, hibernating_{false}, full_update_{false};
 };
 
 }  // namespace waveshare_epaper
@@ -0,0 +1,107 @@
+#include "rle.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace waveshare_epaper {
+namespace rle {
+
+static constexpr size_t MAX_LITERAL = 128;
+static constexpr size_t MAX_REPEAT = 129;
+
+// Length of the run of equal bytes at src, at most MAX_REPEAT.
+static inline size_t repeat_len_(const uint8_t *src, size_t length) {
+  const size_t limit = std::min(length, MAX_REPEAT);
+  size_t n = 1;
+  while (n < limit && src[n] == src[0]) n++;
+  return n;
+}
+
+// Walks the runs of src, calling emit(literal, data, count) for each.
+template<typename F>
+static void runs_(const uint8_t *src, size_t length, F emit) {
+  size_t i = 0;
+  while (i < length) {
+    const size_t repeat = repeat_len_(src + i, length - i);
+    if (repeat >= 2) {
+      emit(false, src + i, repeat);
+      i += repeat;
+      continue;
+    }
+    // literals up to the next pair of equal bytes
+    size_t n = 1;
+    while (n < MAX_LITERAL && i + n < length &&
+           !(i + n + 1 < length && src[i + n] == src[i + n + 1]))
+      n++;
+    emit(true, src + i, n);
+    i += n;
+  }
+}
+
+size_t encoded_size(const uint8_t *src, size_t length) {
+  size_t size = 0;
+  runs_(src, length, [&size](bool literal, const uint8_t *, size_t count) {
+    size += literal ? count + 1 : 2;
+  });
+  return size;
+}
+
+size_t encode(uint8_t *dst, const uint8_t *src, size_t length) {
+  uint8_t *out = dst;
+  runs_(src, length, [&out](bool literal, const uint8_t *data, size_t count) {
+    if (literal) {
+      *out++ = count - 1;
+      memcpy(out, data, count);
+      out += count;
+    } else {
+      *out++ = 0x80 + count - 2;
+      *out++ = data[0];
+    }
+  });
+  return out - dst;
+}
+
+bool Decoder::next_run_() {
+  if (this->pos_ >= this->end_) return false;
+  const uint8_t control = *this->pos_++;
+  this->literal_ = control < 0x80;
+  this->run_ = this->literal_ ? control + 1u : control - 0x80u + 2u;
+  return true;
+}
+
+void Decoder::read(uint8_t *dst, size_t length) {
+  while (length > 0) {
+    if (this->run_ == 0 && !this->next_run_()) {
+      memset(dst, 0xFF, length);
+      return;
+    }
+    const size_t n = std::min(length, this->run_);
+    if (this->literal_) {
+      memcpy(dst, this->pos_, n);
+      this->pos_ += n;
+    } else {
+      memset(dst, *this->pos_, n);
+    }
+    this->run_ -= n;
+    // a repeat run ends on its value byte
+    if (!this->literal_ && this->run_ == 0) this->pos_++;
+    dst += n;
+    length -= n;
+  }
+}
+
+void Decoder::skip(size_t length) {
+  while (length > 0) {
+    if (this->run_ == 0 && !this->next_run_()) return;
+    const size_t n = std::min(length, this->run_);
+    if (this->literal_) this->pos_ += n;
+    this->run_ -= n;
+    if (!this->literal_ && this->run_ == 0) this->pos_++;
+    length -= n;
+  }
+}
+
+}  // namespace rle
+}  // namespace waveshare_epaper
+}  // namespace esphome
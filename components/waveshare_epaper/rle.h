@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace waveshare_epaper {
+namespace rle {
+
+// PackBits style run length coding of a frame. A control byte c < 0x80 is
+// followed by c + 1 literal bytes, c >= 0x80 by one byte repeated
+// c - 0x80 + 2 times.
+
+// Encoded size of src, without writing anything.
+size_t encoded_size(const uint8_t *src, size_t length);
+// Encode src into dst, which holds at least encoded_size() bytes. Returns the
+// number of bytes written.
+size_t encode(uint8_t *dst, const uint8_t *src, size_t length);
+
+// Sequential decoder. Bytes past the end of the stream read as 0xFF, so an
+// empty stream is a white frame.
+class Decoder {
+ public:
+  Decoder(const uint8_t *data, size_t length)
+      : pos_(data), end_(data + length) {}
+
+  void read(uint8_t *dst, size_t length);
+  void skip(size_t length);
+
+ protected:
+  // Start the next run, returns false at the end of the stream.
+  bool next_run_();
+
+  const uint8_t *pos_;
+  const uint8_t *end_;
+  size_t run_{0};  // bytes left in the current run
+  bool literal_{false};
+};
+
+}  // namespace rle
+}  // namespace waveshare_epaper
+}  // namespace esphome
@@ -1,18 +1,87 @@
 #include "waveshare_epaper.h"
+#include "bitplane.h"
+#include "rle.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstddef>
+#include <cstring>
 
 #include "esphome/core/application.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 
+#ifdef USE_ESP32
+#include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#include <esp_memory_utils.h>
+#include <esp_sleep.h>
+#endif
+
 namespace esphome {
 namespace waveshare_epaper {
 
 static const char *const TAG = "waveshare_epaper";
 
+#ifdef USE_ESP32
+static const uint16_t PERSIST_MAGIC = 0xE9A7;
+#ifdef USE_WAVESHARE_EPAPER_PERSIST_SIZE
+static const size_t PERSIST_CAPACITY = USE_WAVESHARE_EPAPER_PERSIST_SIZE;
+#else
+static const size_t PERSIST_CAPACITY = 4096;
+#endif
+
+// Frame shown on the panel, run length coded, see save_frame_().
+struct PersistedFrame {
+  uint16_t magic;
+  uint16_t crc;  // crc16 of everything after it up to the end of the data
+  uint32_t frame_length;
+  uint32_t refresh_count;
+  uint32_t length;
+  uint8_t data[PERSIST_CAPACITY];
+};
+static_assert(offsetof(PersistedFrame, data) == 16,
+              "PERSIST_HEADER_SIZE in display.py");
+
+#ifdef USE_WAVESHARE_EPAPER_PERSIST_RTC
+static RTC_DATA_ATTR PersistedFrame rtc_frame;
+#endif
+
+static uint16_t persisted_crc(const PersistedFrame &frame) {
+  const size_t header = offsetof(PersistedFrame, data) -
+                        offsetof(PersistedFrame, frame_length);
+  return crc16(reinterpret_cast<const uint8_t *>(&frame.frame_length),
+               header + frame.length);
+}
+#endif
+
+void WaveshareEPaperBase::setup() {
+  const uint32_t start = micros();
+  this->apply_native_rotation_();
+  this->setup_pins_();
+  if (this->is_failed()) return;
+  this->initialize();
+  this->setup_time_ = micros() - start;
+}
+
 void WaveshareEPaperBase::setup_pins_() {
-  this->init_internal_(this->get_buffer_length_());
+  const uint32_t length = this->get_buffer_alloc_length_();
+  if (this->static_buffer_ != nullptr &&
+      this->static_buffer_length_ >= length) {
+    this->buffer_ = this->static_buffer_;
+  } else {
+    if (this->static_buffer_ != nullptr)
+      ESP_LOGW(TAG, "Static buffer too small (%zu < %" PRIu32 " bytes)",
+               this->static_buffer_length_, length);
+    this->buffer_ = this->allocate_buffer_(length);
+  }
+  if (this->buffer_ == nullptr) {
+    ESP_LOGE(TAG, "Could not allocate buffer for display!");
+    this->mark_failed();
+    return;
+  }
+  this->fill(display::COLOR_OFF);  // white, in either buffer format
+
   this->dc_pin_->setup();  // OUTPUT
   this->dc_pin_->digital_write(false);
   if (this->reset_pin_ != nullptr) {
@@ -22,10 +91,134 @@ void WaveshareEPaperBase::setup_pins_() {
   if (this->busy_pin_ != nullptr) {
     this->busy_pin_->setup();  // INPUT
   }
+#ifdef USE_ESP32
+  if (this->busy_interrupt_) this->setup_busy_interrupt_();
+  if (this->light_sleep_ &&
+      (this->busy_pin_ == nullptr || !this->busy_pin_->is_internal())) {
+    ESP_LOGW(TAG, "Light sleep needs an internal busy pin, not sleeping");
+    this->light_sleep_ = false;
+  }
+#endif
   this->spi_setup();
 
-  this->reset_();
+  this->start_boot_reset_();
+}
+
+void WaveshareEPaperBase::start_boot_reset_() {
+  if (this->reset_pin_ == nullptr) return;
+
+  this->reset_pin_->digital_write(false);
+  this->boot_reset_ = BOOT_RESET_LOW;
+  this->boot_reset_start_ = millis();
+}
+
+bool WaveshareEPaperBase::poll_boot_reset_(bool wait) {
+  while (this->boot_reset_ != BOOT_RESET_DONE) {
+    const uint32_t elapsed = millis() - this->boot_reset_start_;
+    if (this->boot_reset_ == BOOT_RESET_LOW &&
+        elapsed >= this->reset_duration_) {
+      this->reset_pin_->digital_write(true);
+      this->boot_reset_ = BOOT_RESET_HIGH;
+      this->boot_reset_start_ = millis();
+    } else if (this->boot_reset_ == BOOT_RESET_HIGH && elapsed >= 20) {
+      this->boot_reset_ = BOOT_RESET_DONE;
+      ESP_LOGD(TAG,
+               "Setup took %" PRIu32 " us, panel reset done %" PRIu32
+               " ms after boot%s",
+               this->setup_time_, millis(), wait ? " (waited for)" : "");
+    } else if (wait) {
+      delay(1);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+void WaveshareEPaperBase::apply_native_rotation_() {
+  if (!this->native_rotation_ ||
+      this->rotation_ == display::DISPLAY_ROTATION_0_DEGREES)
+    return;
+
+  const int width = this->get_width_internal();
+  const int height = this->get_height_internal();
+  const bool quarter = this->rotation_ != display::DISPLAY_ROTATION_180_DEGREES;
+  // whole bytes in both directions, so the transforms never split a byte
+  if (width % 8 != 0 || this->get_width_controller() != width ||
+      (quarter && height % 8 != 0)) {
+    ESP_LOGW(TAG, "Native rotation needs a %s that is a multiple of 8, "
+                  "rotating per pixel",
+             quarter ? "width and height" : "width");
+    return;
+  }
+
+  // bands are streamed as they are drawn, only the controller can turn them
+  const bool flip = !quarter && this->can_flip_scan_();
+  if (this->band_height_ != 0 && !flip) {
+    ESP_LOGW(TAG, "Native rotation is not available with band_height, "
+                  "rotating per pixel");
+    return;
+  }
+
+  if (quarter) {
+    RAMAllocator<uint8_t> allocator(RAMAllocator<uint8_t>::ALLOC_INTERNAL |
+                                    RAMAllocator<uint8_t>::ALLOW_FAILURE);
+    this->band_buffer_ = allocator.allocate(width);  // 8 rows of width / 8
+    if (this->band_buffer_ == nullptr) {
+      ESP_LOGW(TAG, "Could not allocate rotation band, rotating per pixel");
+      return;
+    }
+  }
+
+  if (flip) {
+    this->scan_flipped_ = true;
+  } else {
+    this->buffer_rotation_ = this->rotation_;
+  }
+  this->rotation_ = display::DISPLAY_ROTATION_0_DEGREES;
+}
+
+int WaveshareEPaperBase::get_width() {
+  return this->swaps_axes_() ? this->get_height_internal()
+                             : DisplayBuffer::get_width();
+}
+
+int WaveshareEPaperBase::get_height() {
+  return this->swaps_axes_() ? this->get_width_internal()
+                             : DisplayBuffer::get_height();
+}
+
+uint8_t *WaveshareEPaperBase::allocate_buffer_(size_t length) {
+  using Allocator = RAMAllocator<uint8_t>;
+  switch (this->buffer_placement_) {
+    case PLACEMENT_PSRAM:
+      return Allocator(Allocator::ALLOC_EXTERNAL | Allocator::ALLOW_FAILURE)
+          .allocate(length);
+    case PLACEMENT_DMA:
+#ifdef USE_ESP32
+      return static_cast<uint8_t *>(heap_caps_malloc(
+          length, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+#endif
+      // elsewhere all RAM is internal
+    case PLACEMENT_INTERNAL:
+      return Allocator(Allocator::ALLOC_INTERNAL | Allocator::ALLOW_FAILURE)
+          .allocate(length);
+    default:
+      return ExternalRAMAllocator<uint8_t>(
+                 ExternalRAMAllocator<uint8_t>::ALLOW_FAILURE)
+          .allocate(length);
+  }
 }
+
+void WaveshareEPaperBase::free_buffer_(uint8_t *buffer, size_t length) {
+#ifdef USE_ESP32
+  if (this->buffer_placement_ == PLACEMENT_DMA) {
+    heap_caps_free(buffer);
+    return;
+  }
+#endif
+  RAMAllocator<uint8_t>().deallocate(buffer, length);
+}
+
 float WaveshareEPaperBase::get_setup_priority() const {
   return setup_priority::PROCESSOR;
 }
@@ -43,75 +236,941 @@ void WaveshareEPaperBase::data(uint8_t value) {
 // write a command followed by one or more bytes of data.
 // The command is the first byte, length is the total including cmd.
 void WaveshareEPaperBase::cmd_data(const uint8_t *c_data, size_t length) {
+  this->flush_commands_();
   this->dc_pin_->digital_write(false);
   this->enable();
   this->write_byte(c_data[0]);
   this->dc_pin_->digital_write(true);
-  this->write_array(c_data + 1, length - 1);
+  this->write_bulk_(c_data + 1, length - 1);
   this->disable();
 }
 
 void WaveshareEPaperBase::cmd_data(const uint8_t cmd, const uint8_t *c_data,
                                    size_t length) {
+  this->flush_commands_();
   this->dc_pin_->digital_write(false);
   this->enable();
   this->write_byte(cmd);
   this->dc_pin_->digital_write(true);
+  this->write_bulk_(c_data, length);
+  this->disable();
+}
+
+// Write a block of data inside the current transaction. Outside ESP32 the
+// SPI backends stage each write_array() through a small FIFO, so long
+// blocks are split into chunks that fit it, still under a single CS.
+void WaveshareEPaperBase::write_bulk_(const uint8_t *data, size_t length) {
 #ifdef USE_ESP32
-  this->write_array(c_data, length);
+  if (esp_ptr_dma_capable(data)) {
+    this->write_array(data, length);
+    return;
+  }
+  // The SPI driver would allocate a DMA copy of every transfer from PSRAM,
+  // stream through a bounce buffer on the stack instead.
+  uint8_t bounce[BOUNCE_BUFFER_SIZE];
+  while (length > 0) {
+    const size_t chunk = std::min(length, BOUNCE_BUFFER_SIZE);
+    memcpy(bounce, data, chunk);
+    this->write_array(bounce, chunk);
+    data += chunk;
+    length -= chunk;
+  }
 #else
-  unsigned int i;
-  for (i = 0; i < length; i++) this->data(c_data[i]);
+  while (length > 0) {
+    const size_t chunk = std::min(length, BULK_CHUNK_SIZE);
+    this->write_array(data, chunk);
+    data += chunk;
+    length -= chunk;
+  }
 #endif
+}
+
+void WaveshareEPaperBase::write_transformed_(const uint8_t *data,
+                                             size_t length,
+                                             ChunkTransform transform) {
+  uint8_t bounce[BOUNCE_BUFFER_SIZE];
+  while (length > 0) {
+    const size_t chunk = std::min(length, BOUNCE_BUFFER_SIZE);
+    transform(bounce, data, chunk);
+    this->write_bulk_(bounce, chunk);
+    data += chunk;
+    length -= chunk;
+  }
+}
+
+void WaveshareEPaperBase::write_inverted_(const uint8_t *data, size_t length) {
+  this->write_transformed_(data, length, bitplane::invert_copy);
+}
+
+void WaveshareEPaperBase::write_plane_(const uint8_t *plane, size_t length,
+                                       bool invert) {
+  switch (this->buffer_rotation_) {
+    case display::DISPLAY_ROTATION_180_DEGREES: {
+      // last buffer byte first, through the bounce buffer
+      uint8_t bounce[BOUNCE_BUFFER_SIZE];
+      for (size_t end = length; end > 0;) {
+        const size_t chunk = std::min(end, BOUNCE_BUFFER_SIZE);
+        end -= chunk;
+        bitplane::reverse_copy(bounce, plane + end, chunk);
+        if (invert) bitplane::invert_copy(bounce, bounce, chunk);
+        this->write_bulk_(bounce, chunk);
+      }
+      return;
+    }
+
+    case display::DISPLAY_ROTATION_90_DEGREES:
+    case display::DISPLAY_ROTATION_270_DEGREES: {
+      // Controller rows are built 8 at a time from 8 x 8 blocks of buffer_,
+      // whose rows are buffer_stride_() bytes long and run along the
+      // controller columns.
+      const bool cw =
+          this->buffer_rotation_ == display::DISPLAY_ROTATION_90_DEGREES;
+      const ptrdiff_t src_stride = this->buffer_stride_();
+      const ptrdiff_t dst_stride = this->get_width_controller() / 8;
+      const int width = this->get_width_internal();
+      const size_t bands = this->get_height_internal() / 8;
+      for (size_t band = 0; band < bands; band++) {
+        const size_t col = cw ? band : bands - 1 - band;
+        for (ptrdiff_t bx = 0; bx < dst_stride; bx++) {
+          if (cw) {
+            bitplane::transpose8(
+                plane + (width - 1 - 8 * bx) * src_stride + col, -src_stride,
+                this->band_buffer_ + bx, dst_stride);
+          } else {
+            bitplane::transpose8(plane + 8 * bx * src_stride + col, src_stride,
+                                 this->band_buffer_ + 7 * dst_stride + bx,
+                                 -dst_stride);
+          }
+        }
+        if (invert)
+          bitplane::invert_copy(this->band_buffer_, this->band_buffer_,
+                                8 * dst_stride);
+        this->write_bulk_(this->band_buffer_, 8 * dst_stride);
+      }
+      return;
+    }
+
+    default:
+      if (invert) {
+        this->write_inverted_(plane, length);
+      } else {
+        this->write_bulk_(plane, length);
+      }
+      return;
+  }
+}
+
+bool WaveshareEPaperBase::fill_ram_(uint8_t ram_cmd, uint8_t value,
+                                    size_t length) {
+  this->command(ram_cmd);
+  this->start_data_();
+  this->write_repeat_(value, length);
+  this->end_data_();
+  return true;
+}
+
+// The controller fills the black/white (0x24) or red (0x26) RAM by itself.
+// Only all zero or all one patterns map to it, anything else is streamed.
+bool WaveshareEPaperBase::ssd_auto_write_ram_(uint8_t ram_cmd, uint8_t value,
+                                              size_t length, uint8_t steps) {
+  if ((value != 0x00 && value != 0xFF) || (ram_cmd != 0x24 && ram_cmd != 0x26))
+    return WaveshareEPaperBase::fill_ram_(ram_cmd, value, length);
+
+  // A[7]: first step value, a single step covers the panel, so the whole
+  // area gets the same value
+  this->queue_command_(ram_cmd == 0x24 ? 0x47 : 0x46,
+                       (value == 0xFF ? 0x80 : 0x00) | steps);
+  return this->wait_until_idle_();
+}
+
+// Write length copies of value inside the current transaction.
+void WaveshareEPaperBase::write_repeat_(uint8_t value, size_t length) {
+  uint8_t block[BULK_CHUNK_SIZE];
+  memset(block, value, std::min(length, BULK_CHUNK_SIZE));
+  while (length > 0) {
+    const size_t chunk = std::min(length, BULK_CHUNK_SIZE);
+    this->write_array(block, chunk);
+    length -= chunk;
+  }
+}
+
+void WaveshareEPaperBase::queue_cmd_data_(const uint8_t *c_data,
+                                          size_t length) {
+  this->queue_cmd_data_(c_data[0], c_data + 1, length - 1);
+}
+
+void WaveshareEPaperBase::queue_cmd_data_(uint8_t cmd, const uint8_t *data,
+                                          size_t length) {
+  const size_t entry_len = length + 2;  // cmd, data length, data
+  if (entry_len > COMMAND_QUEUE_SIZE) {
+    this->cmd_data(cmd, data, length);
+    return;
+  }
+  if (this->command_queue_len_ + entry_len > COMMAND_QUEUE_SIZE)
+    this->flush_commands_();
+
+  uint8_t *entry = this->command_queue_ + this->command_queue_len_;
+  entry[0] = cmd;
+  entry[1] = length;
+  memcpy(entry + 2, data, length);
+  this->command_queue_len_ += entry_len;
+}
+
+bool WaveshareEPaperBase::run_sequence_(const uint8_t *sequence,
+                                        size_t length) {
+  for (size_t pos = 0; pos < length;) {
+    const uint8_t cmd = sequence[pos];
+    const uint8_t flags = sequence[pos + 1];
+    const uint8_t data_len = flags & SEQ_LENGTH;
+    this->queue_cmd_data_(cmd, sequence + pos + 2, data_len);
+    pos += data_len + 2u;
+
+    if (flags & SEQ_DELAY) {
+      this->flush_commands_();
+      delay(sequence[pos++]);  // NOLINT
+    }
+    if ((flags & SEQ_WAIT) && !this->wait_until_idle_()) return false;
+  }
+  return true;
+}
+
+void WaveshareEPaperBase::flush_commands_() {
+  if (this->command_queue_len_ == 0) return;
+
+  // cleared first, as the SPI helpers below flush on their own
+  const size_t queue_len = this->command_queue_len_;
+  this->command_queue_len_ = 0;
+
+  this->enable();
+  for (size_t pos = 0; pos < queue_len;) {
+    const uint8_t len = this->command_queue_[pos + 1];
+    this->dc_pin_->digital_write(false);
+    this->write_byte(this->command_queue_[pos]);
+    if (len != 0) {
+      this->dc_pin_->digital_write(true);
+      this->write_array(this->command_queue_ + pos + 2, len);
+    }
+    pos += len + 2u;
+  }
   this->disable();
 }
 
-bool WaveshareEPaperBase::wait_until_idle_() {
-  auto is_busy = [this]() -> bool {
-    return this->is_busy_pin_inverted_() ? !this->busy_pin_->digital_read()
-                                         : this->busy_pin_->digital_read();
-  };
+bool WaveshareEPaperBase::is_busy_() {
+  this->flush_commands_();
+  if (this->busy_pin_ == nullptr) return false;
+  return this->is_busy_pin_inverted_() ? !this->busy_pin_->digital_read()
+                                       : this->busy_pin_->digital_read();
+}
 
-  if (this->busy_pin_ == nullptr || !is_busy()) {
+bool WaveshareEPaperBase::wait_until_idle_() {
+  if (!this->is_busy_()) {
     return true;
   }
 
   const uint32_t start = millis();
-  while (is_busy()) {
-    if (millis() - start > this->idle_timeout_()) {
+  while (this->is_busy_()) {
+    const uint32_t elapsed = millis() - start;
+    if (elapsed > this->idle_timeout_()) {
       ESP_LOGE(TAG, "Timeout while displaying image!");
+      this->busy_wait_time_ += elapsed;
       return false;
     }
     App.feed_wdt();
+#ifdef USE_ESP32
+    // block until BUSY is released, in slices short enough for the watchdog
+    const uint32_t wait =
+        std::min<uint32_t>(this->idle_timeout_() - elapsed + 1, 1000);
+    if (this->light_sleep_ && this->light_sleep_until_idle_(wait)) continue;
+    if (this->busy_semaphore_ != nullptr) {
+      // an edge from before the take is caught by is_busy_() above
+      xSemaphoreTake(this->busy_semaphore_, pdMS_TO_TICKS(wait));
+      continue;
+    }
+#endif
     delay(1);
   }
+  this->busy_wait_time_ += millis() - start;
   return true;
 }
 
+#ifdef USE_ESP32
+void WaveshareEPaperBase::setup_busy_interrupt_() {
+  if (this->busy_pin_ == nullptr || !this->busy_pin_->is_internal()) {
+    ESP_LOGW(TAG, "busy_interrupt needs an internal busy pin, polling it");
+    return;
+  }
+  this->busy_semaphore_ = xSemaphoreCreateBinary();
+  if (this->busy_semaphore_ == nullptr) {
+    ESP_LOGW(TAG, "Could not create the busy semaphore, polling BUSY");
+    return;
+  }
+  // BUSY is released on the rising edge if it is active low
+  static_cast<InternalGPIOPin *>(this->busy_pin_)
+      ->attach_interrupt(&WaveshareEPaperBase::busy_isr_, this,
+                         this->is_busy_pin_inverted_()
+                             ? gpio::INTERRUPT_RISING_EDGE
+                             : gpio::INTERRUPT_FALLING_EDGE);
+}
+
+bool WaveshareEPaperBase::light_sleep_until_idle_(uint32_t timeout) {
+  const auto pin = static_cast<gpio_num_t>(
+      static_cast<InternalGPIOPin *>(this->busy_pin_)->get_pin());
+  // level of the released BUSY on the pin itself; a level wake fires right
+  // away if it is there already
+  const bool high =
+      this->is_busy_pin_inverted_() != this->busy_pin_->is_inverted();
+
+  // the wake source turns the pin's interrupt into a level one, the edge
+  // ISR of busy_interrupt would fire without pause until it is disabled
+  if (this->busy_semaphore_ != nullptr) gpio_intr_disable(pin);
+
+  const uint32_t start = millis();
+  gpio_wakeup_enable(pin, high ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup(timeout * 1000ull);
+  const bool slept = esp_light_sleep_start() == ESP_OK;
+  gpio_wakeup_disable(pin);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+
+  if (this->busy_semaphore_ != nullptr) {
+    // back to the release edge set up by setup_busy_interrupt_()
+    gpio_set_intr_type(pin, high ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE);
+    gpio_intr_enable(pin);
+  }
+
+  if (slept) this->busy_sleep_time_ += millis() - start;
+  return slept;
+}
+
+void IRAM_ATTR WaveshareEPaperBase::busy_isr_(WaveshareEPaperBase *arg) {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(arg->busy_semaphore_, &woken);
+  if (woken == pdTRUE) portYIELD_FROM_ISR();
+}
+#endif
+
 void WaveshareEPaperBase::update() {
-  this->do_update_();
-  this->display();
+  this->poll_boot_reset_(true);
+  if (this->phase_ != PHASE_IDLE) {
+    ESP_LOGW(TAG, "Refresh still in progress, skipping update");
+    return;
+  }
+
+  // in paged mode the frame is drawn band by band during the transfer
+  if (!this->paged_()) {
+    this->do_update_();
+    this->on_frame_drawn_();
+    // also hashed when forced, it becomes shown_hash_ once shown
+    if (this->skip_unchanged_ && this->compares_hash_()) {
+      this->drawn_hash_ =
+          bitplane::hash(this->buffer_, this->get_buffer_length_());
+      this->drawn_hash_valid_ = true;
+    }
+  }
+  if (this->skip_unchanged_ && !this->force_update_ && !this->paged_() &&
+      !this->frame_changed_()) {
+    this->skipped_refreshes_++;
+    ESP_LOGD(TAG, "Frame unchanged, skipping refresh (%" PRIu32 " skipped)",
+             this->skipped_refreshes_);
+    return;
+  }
+  if (this->async_refresh_) {
+    this->set_phase_(PHASE_INIT);
+  } else {
+    this->display();
+  }
+}
+
+void WaveshareEPaperBase::display() {
+  this->poll_boot_reset_(true);
+  if (!this->prepare_display_()) {
+    this->flush_commands_();
+    return;
+  }
+
+  if (!this->transfer_display_() ||
+      (this->refresh_uses_busy_() && !this->wait_until_idle_())) {
+    this->flush_commands_();
+    this->fail_refresh_();
+    return;
+  }
+
+  this->complete_refresh_();
+}
+
+// Advance the asynchronous refresh by one phase per loop iteration, so the
+// main loop keeps running while the panel holds BUSY during the refresh.
+void WaveshareEPaperBase::loop() {
+  if (!this->poll_boot_reset_(false)) return;
+
+  switch (this->phase_) {
+    case PHASE_IDLE:
+      return;
+
+    case PHASE_INIT:
+      this->set_phase_(this->prepare_display_() ? PHASE_TRANSFER : PHASE_IDLE);
+      return;
+
+    case PHASE_TRANSFER:
+      if (!this->transfer_display_()) {
+        this->fail_refresh_();
+        this->set_phase_(PHASE_IDLE);
+        return;
+      }
+      this->set_phase_(this->refresh_uses_busy_() ? PHASE_REFRESH
+                                                  : PHASE_SLEEP);
+      return;
+
+    case PHASE_REFRESH:
+      if (this->is_busy_()) {
+        if (millis() - this->phase_start_ > this->idle_timeout_()) {
+          ESP_LOGE(TAG, "Timeout while displaying image!");
+          this->fail_refresh_();
+          this->set_phase_(PHASE_IDLE);
+        }
+        return;
+      }
+      this->set_phase_(PHASE_SLEEP);
+      return;
+
+    case PHASE_SLEEP:
+      this->complete_refresh_();
+      this->set_phase_(PHASE_IDLE);
+      return;
+  }
+}
+
+void WaveshareEPaperBase::set_phase_(RefreshPhase phase) {
+  this->flush_commands_();
+  ESP_LOGV(TAG, "Refresh phase %u -> %u", this->phase_, phase);
+  this->phase_ = phase;
+  this->phase_start_ = millis();
+}
+
+bool WaveshareEPaperBase::frame_changed_() {
+  return !this->shown_hash_valid_ || this->drawn_hash_ != this->shown_hash_;
+}
+
+void WaveshareEPaperBase::complete_refresh_() {
+  this->status_clear_warning();
+  // a frame shown without update() hashing it (paged, or display() called
+  // directly) is unknown, the next frame is never skipped against it
+  this->shown_hash_ = this->drawn_hash_;
+  this->shown_hash_valid_ = this->drawn_hash_valid_;
+  this->drawn_hash_valid_ = false;
+  this->force_update_ = false;
+  this->on_frame_shown_();
+  this->finish_display_();
+  this->flush_commands_();
+  if (this->light_sleep_) {
+    ESP_LOGD(TAG,
+             "Waited %" PRIu32 " ms for BUSY since boot, %" PRIu32
+             " ms of it in light sleep",
+             this->busy_wait_time_, this->busy_sleep_time_);
+  }
+  this->refresh_callback_.call();
+}
+
+void WaveshareEPaperBase::fail_refresh_() {
+  this->status_set_warning();
+  // the controller state is unknown, send all registers again
+  this->clear_shadow_();
+}
+
+bool WaveshareEPaperBase::shadow_update_(uint8_t cmd, const uint8_t *data,
+                                         size_t length) {
+  const uint32_t hash = bitplane::hash(data, length);
+  for (size_t i = 0; i < this->shadow_len_; i++) {
+    if (this->shadow_[i].cmd != cmd) continue;
+    if (this->shadow_[i].hash == hash) return false;
+    this->shadow_[i].hash = hash;
+    return true;
+  }
+  // registers beyond SHADOW_SIZE are simply always sent
+  if (this->shadow_len_ < SHADOW_SIZE)
+    this->shadow_[this->shadow_len_++] = {cmd, hash};
+  return true;
 }
+
+void WaveshareEPaperBase::write_register_(uint8_t cmd, const uint8_t *data,
+                                          size_t length) {
+  if (this->shadow_update_(cmd, data, length))
+    this->cmd_data(cmd, data, length);
+}
+
+bool WaveshareEPaperBase::defer_deep_sleep_() {
+  if (this->standby_timeout_ == 0) return false;
+
+  this->set_timeout("standby", this->standby_timeout_, [this]() {
+    if (this->phase_ != PHASE_IDLE) {
+      this->defer_deep_sleep_();
+      return;
+    }
+    ESP_LOGD(TAG, "No update for %" PRIu32 " ms, entering deep sleep",
+             this->standby_timeout_);
+    this->deep_sleep();
+    this->flush_commands_();
+  });
+  return true;
+}
+
 void WaveshareEPaper::fill(Color color) {
   // flip logic
   const uint8_t fill = color.is_on() ? 0x00 : 0xFF;
-  for (uint32_t i = 0; i < this->get_buffer_length_(); i++)
-    this->buffer_[i] = fill;
+  bitplane::fill(this->buffer_, fill, this->get_buffer_length_());
+  this->seed_pending_ = false;
+  this->mark_all_dirty_();
 }
 void HOT WaveshareEPaper::draw_absolute_pixel_internal(int x, int y,
                                                        Color color) {
-  if (x >= this->get_width_internal() || y >= this->get_height_internal() ||
-      x < 0 || y < 0)
+  this->set_pixel_(x, y, color, this->buffer_width_(), this->buffer_height_(),
+                   this->buffer_stride_());
+}
+
+void WaveshareEPaper::horizontal_line(int x, int y, int width, Color color) {
+  this->filled_rectangle(x, y, width, 1, color);
+}
+
+void WaveshareEPaper::filled_rectangle(int x1, int y1, int width, int height,
+                                       Color color) {
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    display::Display::filled_rectangle(x1, y1, width, height, color);
+    return;
+  }
+  int x2 = x1 + width, y2 = y1 + height;
+  if (!this->clip_rect_(x1, y1, x2, y2)) return;
+  this->fill_rect_(x1, y1, x2, y2, color.is_on());
+}
+
+void WaveshareEPaper::fill_rect_(int x1, int y1, int x2, int y2, bool on) {
+  if (this->seed_pending_) this->seed_buffer_();
+  this->expand_dirty_(x1, y1, x2 - 1, y2 - 1);
+
+  // flip logic
+  bitplane::fill_rect(this->buffer_, this->buffer_stride_(), x1, y1, x2, y2,
+                      on ? 0x00 : 0xFF);
+}
+
+// Same source decoding as Display::draw_pixels_at(), any non-zero pixel is
+// on, written straight into buffer_ instead of through draw_pixel_at().
+void WaveshareEPaper::draw_pixels_at(int x_start, int y_start, int w, int h,
+                                     const uint8_t *ptr,
+                                     display::ColorOrder order,
+                                     display::ColorBitness bitness,
+                                     bool big_endian, int x_offset,
+                                     int y_offset, int x_pad) {
+  int x1 = x_start, y1 = y_start, x2 = x_start + w, y2 = y_start + h;
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    display::Display::draw_pixels_at(x_start, y_start, w, h, ptr, order,
+                                     bitness, big_endian, x_offset, y_offset,
+                                     x_pad);
+    return;
+  }
+  if (!this->clip_rect_(x1, y1, x2, y2)) return;
+  if (this->seed_pending_) this->seed_buffer_();
+  this->expand_dirty_(x1, y1, x2 - 1, y2 - 1);
+
+  const size_t bytes_per_pixel = bitness == display::COLOR_BITNESS_888   ? 3
+                                 : bitness == display::COLOR_BITNESS_565 ? 2
+                                                                         : 1;
+  const size_t line_stride = x_offset + w + x_pad;
+  const uint32_t stride = this->buffer_stride_();
+  for (int y = y1; y < y2; y++) {
+    const uint8_t *src =
+        ptr + ((y_offset + y - y_start) * line_stride + x_offset + x1 -
+               x_start) *
+                  bytes_per_pixel;
+    uint8_t *row = this->buffer_ + y * stride;
+    for (int x = x1; x < x2; x++, src += bytes_per_pixel) {
+      bool on = src[0] != 0;
+      for (size_t i = 1; i < bytes_per_pixel; i++) on |= src[i] != 0;
+      // flip logic
+      if (on) {
+        row[x / 8u] &= ~(0x80 >> (x & 0x07));
+      } else {
+        row[x / 8u] |= 0x80 >> (x & 0x07);
+      }
+    }
+  }
+}
+
+void WaveshareEPaper::draw_bitmap(int x, int y, int w, int h,
+                                  const uint8_t *bitmap, Color color_on,
+                                  Color color_off, bool transparent) {
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    this->draw_bitmap_pixels_(x, y, w, h, bitmap, color_on, color_off,
+                              transparent);
     return;
+  }
+  int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+  if (!this->clip_rect_(x1, y1, x2, y2)) return;
+  if (this->seed_pending_) this->seed_buffer_();
+  this->expand_dirty_(x1, y1, x2 - 1, y2 - 1);
 
-  const uint32_t pos = (x + y * this->get_width_controller()) / 8u;
-  const uint8_t subpos = x & 0x07;
+  const size_t src_stride = (w + 7u) / 8u;
   // flip logic
-  if (!color.is_on()) {
-    this->buffer_[pos] |= 0x80 >> subpos;
+  bitplane::blit(this->buffer_, this->buffer_stride_(), x1, y1,
+                 bitmap + (y1 - y) * src_stride, src_stride, x1 - x, x2 - x1,
+                 y2 - y1, color_on.is_on() ? 0x00 : 0xFF,
+                 color_off.is_on() ? 0x00 : 0xFF, transparent);
+}
+
+#ifdef USE_IMAGE
+void WaveshareEPaper::draw_image(int x, int y, image::Image *image,
+                                 Color color_on, Color color_off) {
+  if (!is_blittable_(image)) {
+    image->draw(x, y, this, color_on, color_off);
+    return;
+  }
+  this->draw_bitmap(x, y, image->get_width(), image->get_height(),
+                    image->get_data_start(), color_on, color_off,
+                    image->has_transparency());
+}
+#endif
+
+void WaveshareEPaper::mark_all_dirty_() {
+  this->dirty_x1_ = 0;
+  this->dirty_y1_ = 0;
+  this->dirty_x2_ = this->get_width_controller() - 1;
+  this->dirty_y2_ = this->get_height_internal() - 1;
+}
+
+void WaveshareEPaper::clear_dirty_() {
+  this->dirty_x1_ = UINT16_MAX;
+  this->dirty_y1_ = UINT16_MAX;
+  this->dirty_x2_ = 0;
+  this->dirty_y2_ = 0;
+}
+
+bool WaveshareEPaper::trim_dirty_() {
+  if (!this->is_dirty_()) return false;
+
+  if (this->buffer_rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    // buffer_ is not in controller layout, the window is the whole frame
+    if (!this->frame_changed_()) {
+      this->clear_dirty_();
+      return false;
+    }
+    this->mark_all_dirty_();
+    return true;
+  }
+
+  const uint32_t stride = this->get_width_controller() / 8u;
+  const uint32_t bx1 = this->dirty_x1_ / 8u, bx2 = this->dirty_x2_ / 8u;
+  uint32_t min_bx = UINT32_MAX, max_bx = 0, min_y = UINT32_MAX, max_y = 0;
+
+  // compressed rows are decoded one at a time, for panels up to 2048 wide
+  rle::Decoder old_rows(this->previous_rle_, this->previous_rle_len_);
+  uint8_t row[BOUNCE_BUFFER_SIZE];
+  if (this->compress_previous_) old_rows.skip(this->dirty_y1_ * stride);
+
+  for (uint32_t y = this->dirty_y1_; y <= this->dirty_y2_; y++) {
+    const uint8_t *cur = this->buffer_ + y * stride;
+    const uint8_t *old = this->previous_ + y * stride;
+    if (this->compress_previous_) {
+      old_rows.read(row, stride);
+      old = row;
+    }
+    const uint32_t row_len = bx2 - bx1 + 1u;
+    const uint32_t first = bitplane::first_diff(cur + bx1, old + bx1, row_len);
+    if (first == row_len) continue;  // row unchanged
+    const uint32_t last = bitplane::last_diff(cur + bx1, old + bx1, row_len);
+
+    if (bx1 + first < min_bx) min_bx = bx1 + first;
+    if (bx1 + last > max_bx) max_bx = bx1 + last;
+    if (y < min_y) min_y = y;
+    max_y = y;
+  }
+
+  if (min_y == UINT32_MAX) {
+    this->clear_dirty_();
+    return false;
+  }
+
+  this->dirty_x1_ = min_bx * 8u;
+  this->dirty_x2_ = max_bx * 8u + 7u;
+  this->dirty_y1_ = min_y;
+  this->dirty_y2_ = max_y;
+  return true;
+}
+
+void WaveshareEPaper::write_dirty_window_(const uint8_t *plane) {
+  if (this->buffer_rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    this->write_plane_(plane, this->get_buffer_length_());
+    return;
+  }
+  const uint32_t stride = this->get_width_controller() / 8u;
+  const uint32_t x = this->dirty_x1_ / 8u;
+  const uint32_t width = this->dirty_x2_ / 8u - x + 1u;
+  const uint32_t rows = this->dirty_y2_ - this->dirty_y1_ + 1u;
+  const uint8_t *src = plane + this->dirty_y1_ * stride + x;
+
+  if (width == stride) {  // full rows are contiguous
+    this->write_bulk_(src, width * rows);
+    return;
+  }
+  for (uint32_t row = 0; row < rows; row++, src += stride)
+    this->write_bulk_(src, width);
+}
+
+void WaveshareEPaper::write_previous_window_() {
+  if (!this->compress_previous_) {
+    this->write_dirty_window_(this->previous_);
+    return;
+  }
+
+  const uint32_t stride = this->get_width_controller() / 8u;
+  const uint32_t x = this->dirty_x1_ / 8u;
+  const uint32_t width = this->dirty_x2_ / 8u - x + 1u;
+  const uint32_t rows = this->dirty_y2_ - this->dirty_y1_ + 1u;
+  rle::Decoder old(this->previous_rle_, this->previous_rle_len_);
+  old.skip(this->dirty_y1_ * stride + x);
+
+  uint8_t bounce[BOUNCE_BUFFER_SIZE];
+  if (width == stride) {  // full rows are contiguous
+    for (size_t left = width * rows; left > 0;) {
+      const size_t chunk = std::min(left, BOUNCE_BUFFER_SIZE);
+      old.read(bounce, chunk);
+      this->write_bulk_(bounce, chunk);
+      left -= chunk;
+    }
+    return;
+  }
+  for (uint32_t row = 0; row < rows; row++) {
+    old.read(bounce, width);
+    this->write_bulk_(bounce, width);
+    old.skip(stride - width);
+  }
+}
+
+void WaveshareEPaper::write_previous_() {
+  const size_t length = this->get_buffer_length_();
+  if (!this->compress_previous_) {
+    this->write_plane_(this->previous_, length);
+    return;
+  }
+
+  rle::Decoder old(this->previous_rle_, this->previous_rle_len_);
+  uint8_t bounce[BOUNCE_BUFFER_SIZE];
+  for (size_t left = length; left > 0;) {
+    const size_t chunk = std::min(left, BOUNCE_BUFFER_SIZE);
+    old.read(bounce, chunk);
+    this->write_bulk_(bounce, chunk);
+    left -= chunk;
+  }
+}
+
+void WaveshareEPaper::clear_previous_() {
+  if (this->compress_previous_) {
+    this->previous_rle_len_ = 0;  // decodes as white
   } else {
-    this->buffer_[pos] &= ~(0x80 >> subpos);
+    bitplane::fill(this->previous_, 0xFF, this->get_buffer_length_());
+  }
+}
+
+void WaveshareEPaper::store_previous_() {
+  const size_t length = this->get_buffer_length_();
+  const size_t size = rle::encoded_size(this->buffer_, length);
+  if (size > this->previous_rle_capacity_) {
+    // some headroom, so that similar frames do not reallocate
+    const size_t capacity = size + size / 4u;
+    uint8_t *store = this->allocate_buffer_(capacity);
+    if (store == nullptr) {
+      ESP_LOGW(TAG, "Could not allocate %zu bytes for the previous frame",
+               capacity);
+      this->previous_rle_len_ = 0;
+      return;
+    }
+    if (this->previous_rle_ != nullptr)
+      this->free_buffer_(this->previous_rle_, this->previous_rle_capacity_);
+    this->previous_rle_ = store;
+    this->previous_rle_capacity_ = capacity;
   }
+  this->previous_rle_len_ = rle::encode(this->previous_rle_, this->buffer_,
+                                        length);
+  ESP_LOGV(TAG, "Previous frame compressed to %zu of %zu bytes",
+           this->previous_rle_len_, length);
+}
+
+void WaveshareEPaper::init_previous_(uint32_t *refresh_count) {
+  this->refresh_count_ = refresh_count;
+  if (this->compress_previous_) {
+    // starts out empty, which decodes as the white frame the panel is
+    // assumed to show
+    if (this->buffer_rotation_ == display::DISPLAY_ROTATION_0_DEGREES) {
+      this->restore_frame_();
+      return;
+    }
+    ESP_LOGW(TAG, "Native rotation needs the full previous frame, "
+                  "not compressing it");
+    this->compress_previous_ = false;
+  }
+  if (this->static_previous_ != nullptr &&
+      this->static_previous_length_ >= this->get_buffer_length_()) {
+    this->previous_ = this->static_previous_;
+  } else {
+    this->previous_ = this->allocate_buffer_(this->get_buffer_length_());
+  }
+  if (this->previous_ == nullptr) {
+    ESP_LOGE(TAG, "Could not allocate previous frame buffer!");
+    this->mark_failed();
+    return;
+  }
+  bitplane::fill(this->previous_, 0xFF, this->get_buffer_length_());
+  this->restore_frame_();
+}
+
+void WaveshareEPaper::seed_buffer_() {
+  bitplane::copy(this->buffer_, this->previous_, this->get_buffer_length_());
+  this->seed_pending_ = false;
+}
+
+void WaveshareEPaper::on_frame_drawn_() {
+  // nothing was drawn, the frame is the one already shown
+  if (this->seed_pending_) this->seed_buffer_();
+}
+
+bool WaveshareEPaper::frame_changed_() {
+  const size_t length = this->get_buffer_length_();
+  if (this->compress_previous_) {
+    rle::Decoder old(this->previous_rle_, this->previous_rle_len_);
+    uint8_t chunk[BOUNCE_BUFFER_SIZE];
+    for (size_t pos = 0; pos < length; pos += BOUNCE_BUFFER_SIZE) {
+      const size_t n = std::min(length - pos, BOUNCE_BUFFER_SIZE);
+      old.read(chunk, n);
+      if (bitplane::first_diff(this->buffer_ + pos, chunk, n) != n) return true;
+    }
+    return false;
+  }
+  if (this->previous_ == nullptr) return WaveshareEPaperBase::frame_changed_();
+  return bitplane::first_diff(this->buffer_, this->previous_, length) != length;
+}
+
+void WaveshareEPaper::on_frame_shown_() {
+  this->clear_dirty_();
+  if (this->compress_previous_) {
+    this->store_previous_();
+  } else if (this->previous_ != nullptr) {
+    std::swap(this->buffer_, this->previous_);
+    this->seed_pending_ = true;
+  }
+  this->frame_known_ = true;
+  // flash wears, it is only written on shutdown
+  if (this->frame_persistence_ == PERSIST_RTC) this->save_frame_();
+  if (this->flash_frame_stale_) {
+    // A restored record no longer matches the panel. It is dropped at once,
+    // so a reset without safe shutdown does not bring it back.
+    this->save_frame_(false);
+    global_preferences->sync();
+    this->flash_frame_stale_ = false;
+  }
+}
+
+void WaveshareEPaper::on_safe_shutdown() {
+  WaveshareEPaperBase::on_safe_shutdown();
+  if (this->frame_persistence_ == PERSIST_FLASH && this->frame_known_)
+    this->save_frame_();
+}
+
+void WaveshareEPaper::save_frame_(bool valid) {
+#ifdef USE_ESP32
+  if (this->frame_persistence_ == PERSIST_NONE) return;
+
+  PersistedFrame *frame = nullptr;
+#ifdef USE_WAVESHARE_EPAPER_PERSIST_RTC
+  if (this->frame_persistence_ == PERSIST_RTC) frame = &rtc_frame;
+#endif
+  RAMAllocator<PersistedFrame> allocator(
+      RAMAllocator<PersistedFrame>::ALLOW_FAILURE);
+  if (frame == nullptr) {
+    frame = allocator.allocate(1);
+    if (frame == nullptr) return;
+  }
+
+  const size_t length = this->get_buffer_length_();
+  // an invalid record replaces the stale one if the frame does not fit
+  frame->magic = 0;
+  frame->length = 0;
+  if (!valid) {
+    // dropped, see on_frame_shown_()
+  } else if (this->compress_previous_) {
+    if (this->previous_rle_len_ <= PERSIST_CAPACITY) {
+      memcpy(frame->data, this->previous_rle_, this->previous_rle_len_);
+      frame->length = this->previous_rle_len_;
+      frame->magic = PERSIST_MAGIC;
+    }
+  } else if (rle::encoded_size(this->previous_, length) <= PERSIST_CAPACITY) {
+    frame->length = rle::encode(frame->data, this->previous_, length);
+    frame->magic = PERSIST_MAGIC;
+  }
+  if (valid && frame->magic != PERSIST_MAGIC)
+    ESP_LOGW(TAG, "Frame does not fit in %zu bytes, not persisted",
+             PERSIST_CAPACITY);
+
+  frame->frame_length = length;
+  frame->refresh_count =
+      this->refresh_count_ != nullptr ? *this->refresh_count_ : 0;
+  frame->crc = persisted_crc(*frame);
+
+  if (this->frame_persistence_ == PERSIST_FLASH) {
+    this->frame_pref_.save(frame);
+    allocator.deallocate(frame, 1);
+  }
+#endif
+}
+
+bool WaveshareEPaper::restore_frame_() {
+#ifdef USE_ESP32
+  if (this->frame_persistence_ == PERSIST_NONE) return false;
+  // decoded into buffer_ in compressed mode, previous_ otherwise
+  if ((this->compress_previous_ ? this->buffer_ : this->previous_) == nullptr)
+    return false;
+
+  PersistedFrame *frame = nullptr;
+#ifdef USE_WAVESHARE_EPAPER_PERSIST_RTC
+  if (this->frame_persistence_ == PERSIST_RTC) frame = &rtc_frame;
+#endif
+  RAMAllocator<PersistedFrame> allocator(
+      RAMAllocator<PersistedFrame>::ALLOW_FAILURE);
+  if (this->frame_persistence_ == PERSIST_FLASH) {
+    this->frame_pref_ = global_preferences->make_preference<PersistedFrame>(
+        fnv1_hash("waveshare_epaper_frame"), true);
+    frame = allocator.allocate(1);
+    if (frame == nullptr) return false;
+    if (!this->frame_pref_.load(frame)) frame->magic = 0;
+  }
+  if (frame == nullptr) return false;
+
+  const size_t length = this->get_buffer_length_();
+  const bool valid = frame->magic == PERSIST_MAGIC &&
+                     frame->frame_length == length &&
+                     frame->length <= PERSIST_CAPACITY &&
+                     frame->crc == persisted_crc(*frame);
+  if (valid) {
+    // buffer_ holds the shown frame in compressed mode, previous_ otherwise
+    rle::Decoder decoder(frame->data, frame->length);
+    if (this->compress_previous_) {
+      decoder.read(this->buffer_, length);
+      this->store_previous_();
+    } else {
+      decoder.read(this->previous_, length);
+      this->seed_pending_ = true;
+    }
+    if (this->refresh_count_ != nullptr)
+      *this->refresh_count_ = frame->refresh_count;
+    // the panel content is known, an unchanged frame can be skipped
+    this->force_update_ = false;
+    this->frame_known_ = true;
+    this->flash_frame_stale_ = this->frame_persistence_ == PERSIST_FLASH;
+    ESP_LOGD(TAG, "Restored the previous frame, %" PRIu32 " bytes coded",
+             frame->length);
+  }
+  if (this->frame_persistence_ == PERSIST_FLASH) allocator.deallocate(frame, 1);
+  return valid;
+#else
+  return false;
+#endif
 }
 
 uint32_t WaveshareEPaper::get_buffer_length_() {
@@ -121,47 +1180,255 @@ uint32_t WaveshareEPaperBWR::get_buffer_length_() {
   return this->get_width_controller() * this->get_height_internal() / 4u;
 }  // black and red buffer
 
+WaveshareEPaperBWR::PlaneBits WaveshareEPaperBWR::classify_(Color color) {
+  PlaneBits bits;
+  bits.black = color.is_on() ? 0xFF : 0x00;
+  // draw red pixels only, if the color contains red only, or is yellow
+  const bool red = (color.red > 0 && color.green == 0 && color.blue == 0) ||
+                   (color.red == 255 && color.green == 255 && color.blue == 0);
+  bits.red = red ? 0xFF : 0x00;
+  return bits;
+}
+
 void WaveshareEPaperBWR::fill(Color color) {
-  this->filled_rectangle(0, 0, this->get_width(), this->get_height(), color);
+  const uint32_t plane_len = this->plane_length_();
+  const PlaneBits bits = this->plane_bits_(color);
+  bitplane::fill(this->buffer_, bits.black, plane_len);
+  bitplane::fill(this->buffer_ + plane_len, bits.red, plane_len);
 }
+
 void HOT WaveshareEPaperBWR::draw_absolute_pixel_internal(int x, int y,
                                                           Color color) {
-  if (x >= this->get_width_internal() || y >= this->get_height_internal() ||
-      x < 0 || y < 0)
+  this->set_pixel_(x, y, color, this->buffer_width_(), this->buffer_height_(),
+                   this->buffer_stride_());
+}
+
+void WaveshareEPaperBWR::horizontal_line(int x, int y, int width,
+                                         Color color) {
+  this->filled_rectangle(x, y, width, 1, color);
+}
+
+void WaveshareEPaperBWR::filled_rectangle(int x1, int y1, int width,
+                                          int height, Color color) {
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    display::Display::filled_rectangle(x1, y1, width, height, color);
     return;
+  }
+  int x2 = x1 + width, y2 = y1 + height;
+  if (!this->clip_rect_(x1, y1, x2, y2)) return;
 
-  const uint32_t buf_half_len = this->get_buffer_length_() / 2u;
+  const PlaneBits bits = this->plane_bits_(color);
+  const uint32_t stride = this->buffer_stride_();
+  y1 -= this->band_y_;
+  y2 -= this->band_y_;
+  bitplane::fill_rect(this->buffer_, stride, x1, y1, x2, y2, bits.black);
+  bitplane::fill_rect(this->buffer_ + this->plane_length_(), stride, x1, y1,
+                      x2, y2, bits.red);
+}
 
-  const uint32_t pos = (x + y * this->get_width_internal()) / 8u;
-  const uint8_t subpos = x & 0x07;
-  // flip logic
-  if (color.is_on()) {
-    this->buffer_[pos] |= 0x80 >> subpos;
-  } else {
-    this->buffer_[pos] &= ~(0x80 >> subpos);
+// Same source decoding as Display::draw_pixels_at(). Runs of the same source
+// value reuse the last classification, so the color conversion only happens
+// where the color changes.
+void WaveshareEPaperBWR::draw_pixels_at(int x_start, int y_start, int w, int h,
+                                        const uint8_t *ptr,
+                                        display::ColorOrder order,
+                                        display::ColorBitness bitness,
+                                        bool big_endian, int x_offset,
+                                        int y_offset, int x_pad) {
+  int x1 = x_start, y1 = y_start, x2 = x_start + w, y2 = y_start + h;
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    display::Display::draw_pixels_at(x_start, y_start, w, h, ptr, order,
+                                     bitness, big_endian, x_offset, y_offset,
+                                     x_pad);
+    return;
+  }
+  if (!this->clip_rect_(x1, y1, x2, y2)) return;
+
+  const size_t bytes_per_pixel = bitness == display::COLOR_BITNESS_888   ? 3
+                                 : bitness == display::COLOR_BITNESS_565 ? 2
+                                                                         : 1;
+  const size_t line_stride = x_offset + w + x_pad;
+  const uint32_t stride = this->buffer_stride_();
+  const uint32_t plane_len = this->plane_length_();
+  uint32_t last_value = 0;
+  PlaneBits bits = classify_(ColorUtil::to_color(last_value, order, bitness));
+
+  for (int y = y1; y < y2; y++) {
+    const uint8_t *src =
+        ptr + ((y_offset + y - y_start) * line_stride + x_offset + x1 -
+               x_start) *
+                  bytes_per_pixel;
+    uint8_t *black = this->buffer_ + (y - this->band_y_) * stride;
+    uint8_t *red = black + plane_len;
+    for (int x = x1; x < x2; x++, src += bytes_per_pixel) {
+      uint32_t value;
+      switch (bitness) {
+        case display::COLOR_BITNESS_565:
+          value = big_endian ? (src[0] << 8) | src[1] : src[0] | (src[1] << 8);
+          break;
+        case display::COLOR_BITNESS_888:
+          value = big_endian ? (src[0] << 16) | (src[1] << 8) | src[2]
+                             : src[0] | (src[1] << 8) | (src[2] << 16);
+          break;
+        default:
+          value = src[0];
+          break;
+      }
+      if (value != last_value) {
+        last_value = value;
+        bits = classify_(ColorUtil::to_color(value, order, bitness));
+      }
+      const uint8_t mask = 0x80 >> (x & 0x07);
+      const uint32_t pos = x / 8u;
+      black[pos] = (black[pos] & ~mask) | (bits.black & mask);
+      red[pos] = (red[pos] & ~mask) | (bits.red & mask);
+    }
+  }
+}
+
+bool WaveshareEPaperBase::clip_rect_(int &x1, int &y1, int &x2, int &y2) {
+  x1 = std::max(x1, 0);
+  y1 = std::max(y1, this->band_y_);  // 0 unless paged
+  x2 = std::min(x2, this->buffer_width_());
+  y2 = std::min(y2, this->band_end_());
+  if (this->is_clipping()) {
+    const display::Rect clip = this->get_clipping();
+    x1 = std::max<int>(x1, clip.x);
+    y1 = std::max<int>(y1, clip.y);
+    x2 = std::min<int>(x2, clip.x2());
+    y2 = std::min<int>(y2, clip.y2());
   }
+  return x1 < x2 && y1 < y2;
+}
 
-  // draw red pixels only, if the color contains red only
-  if (((color.red > 0) && (color.green == 0) && (color.blue == 0))) { // red
-    this->buffer_[pos + buf_half_len] |= 0x80 >> subpos;
-  } else if (((color.red == 255) && (color.green == 255) && (color.blue == 0))) { // yellow
-    this->buffer_[pos + buf_half_len] |= 0x80 >> subpos;
+int WaveshareEPaperBase::band_end_() {
+  if (!this->paged_()) return this->buffer_height_();
+  return std::min(this->band_y_ + this->band_height_, this->buffer_height_());
+}
+
+void WaveshareEPaperBase::draw_bitmap_pixels_(int x, int y, int w, int h,
+                                              const uint8_t *bitmap,
+                                              Color color_on, Color color_off,
+                                              bool transparent) {
+  const size_t src_stride = (w + 7u) / 8u;
+  for (int j = 0; j < h; j++, bitmap += src_stride) {
+    for (int i = 0; i < w; i++) {
+      if (bitmap[i / 8] & (0x80 >> (i & 0x07))) {
+        this->draw_pixel_at(x + i, y + j, color_on);
+      } else if (!transparent) {
+        this->draw_pixel_at(x + i, y + j, color_off);
+      }
+    }
+  }
+}
+
+void WaveshareEPaperBWR::draw_bitmap(int x, int y, int w, int h,
+                                     const uint8_t *bitmap, Color color_on,
+                                     Color color_off, bool transparent) {
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    this->draw_bitmap_pixels_(x, y, w, h, bitmap, color_on, color_off,
+                              transparent);
+    return;
+  }
+  int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+  if (!this->clip_rect_(x1, y1, x2, y2)) return;
+
+  const PlaneBits on = classify_(color_on), off = classify_(color_off);
+  const size_t src_stride = (w + 7u) / 8u;
+  const uint8_t *src = bitmap + (y1 - y) * src_stride;
+  const uint32_t stride = this->buffer_stride_();
+  const int row = y1 - this->band_y_;
+  bitplane::blit(this->buffer_, stride, x1, row, src, src_stride, x1 - x,
+                 x2 - x1, y2 - y1, on.black, off.black, transparent);
+  bitplane::blit(this->buffer_ + this->plane_length_(), stride, x1, row, src,
+                 src_stride, x1 - x, x2 - x1, y2 - y1, on.red, off.red,
+                 transparent);
+}
+
+void WaveshareEPaperBWR::draw_bitmap_planes(int x, int y, int w, int h,
+                                            const uint8_t *black,
+                                            const uint8_t *red) {
+  if (this->rotation_ != display::DISPLAY_ROTATION_0_DEGREES) {
+    this->draw_bitmap_pixels_(x, y, w, h, black, display::COLOR_ON,
+                              display::COLOR_OFF, false);
+    // red pixels are drawn over the black plane
+    if (red != nullptr)
+      this->draw_bitmap_pixels_(x, y, w, h, red, Color(255, 0, 0),
+                                display::COLOR_OFF, true);
+    return;
+  }
+  int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+  if (!this->clip_rect_(x1, y1, x2, y2)) return;
+
+  const size_t src_stride = (w + 7u) / 8u;
+  const size_t src_offset = (y1 - y) * src_stride;
+  const uint32_t stride = this->buffer_stride_();
+  const int row = y1 - this->band_y_;
+  uint8_t *red_plane = this->buffer_ + this->plane_length_();
+  bitplane::blit(this->buffer_, stride, x1, row, black + src_offset,
+                 src_stride, x1 - x, x2 - x1, y2 - y1, 0xFF, 0x00, false);
+  if (red == nullptr) {
+    bitplane::fill_rect(red_plane, stride, x1, row, x2, row + y2 - y1, 0x00);
   } else {
-    this->buffer_[pos + buf_half_len] &= ~(0x80 >> subpos);
+    bitplane::blit(red_plane, stride, x1, row, red + src_offset, src_stride,
+                   x1 - x, x2 - x1, y2 - y1, 0xFF, 0x00, false);
   }
 }
 
+#ifdef USE_IMAGE
+void WaveshareEPaperBWR::draw_image(int x, int y, image::Image *image,
+                                    Color color_on, Color color_off) {
+  if (!is_blittable_(image)) {
+    image->draw(x, y, this, color_on, color_off);
+    return;
+  }
+  this->draw_bitmap(x, y, image->get_width(), image->get_height(),
+                    image->get_data_start(), color_on, color_off,
+                    image->has_transparency());
+}
+#endif
+
+bool WaveshareEPaperBWR::transfer_display_() {
+  const int height = this->buffer_height_();
+  if (!this->paged_()) {
+    this->write_band_(0, height);
+    return this->trigger_refresh_();
+  }
+
+  // The controller keeps the whole frame, so the bands only need to be sent
+  // once. Drawing outside the current band is clipped away.
+  for (this->band_y_ = 0; this->band_y_ < height;
+       this->band_y_ += this->band_height_) {
+    this->do_update_();
+    this->write_band_(this->band_y_, this->band_end_() - this->band_y_);
+    App.feed_wdt();
+  }
+  this->band_y_ = 0;
+  return this->trigger_refresh_();
+}
+
 void WaveshareEPaperBase::start_command_() {
+  this->flush_commands_();
   this->dc_pin_->digital_write(false);
   this->enable();
 }
 void WaveshareEPaperBase::end_command_() { this->disable(); }
 void WaveshareEPaperBase::start_data_() {
+  this->flush_commands_();
   this->dc_pin_->digital_write(true);
   this->enable();
 }
 void WaveshareEPaperBase::end_data_() { this->disable(); }
-void WaveshareEPaperBase::on_safe_shutdown() { this->deep_sleep(); }
+void WaveshareEPaperBase::on_safe_shutdown() {
+  this->poll_boot_reset_(true);
+  // a refresh that finishes here is on the panel, even if cut short
+  if ((this->phase_ == PHASE_REFRESH && this->wait_until_idle_()) ||
+      this->phase_ == PHASE_SLEEP)
+    this->on_frame_shown_();
+  this->phase_ = PHASE_IDLE;
+  this->deep_sleep();
+  this->flush_commands_();
+}
 
 }  // namespace waveshare_epaper
 }  // namespace esphome
\ No newline at end of file
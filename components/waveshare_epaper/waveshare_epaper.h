@@ -1,8 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+
 #include "esphome/components/display/display_buffer.h"
 #include "esphome/components/spi/spi.h"
+#include "esphome/core/automation.h"
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/preferences.h"
+
+#ifdef USE_IMAGE
+#include "esphome/components/image/image.h"
+#endif
+
+#ifdef USE_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
 
 namespace esphome {
 namespace waveshare_epaper {
@@ -13,6 +29,36 @@ enum RefreshMode {
   FAST_REFRESH,
 };
 
+enum BufferPlacement : uint8_t {
+  PLACEMENT_AUTO = 0,  // PSRAM if available, internal RAM otherwise
+  PLACEMENT_PSRAM,
+  PLACEMENT_INTERNAL,
+  PLACEMENT_DMA,     // internal RAM the SPI DMA can read directly
+  PLACEMENT_STATIC,  // arrays generated by display.py, see set_static_buffer()
+};
+
+enum FramePersistence : uint8_t {
+  PERSIST_NONE = 0,
+  PERSIST_RTC,    // RTC slow memory, kept over deep sleep
+  PERSIST_FLASH,  // preferences in flash, also kept over power loss
+};
+
+enum RefreshPhase : uint8_t {
+  PHASE_IDLE = 0,
+  // INIT and TRANSFER each run in one loop() pass, blocking in the drivers'
+  // reset delays and power-on BUSY waits; only REFRESH is polled.
+  PHASE_INIT,      // reset and register programming
+  PHASE_TRANSFER,  // frame transfer and refresh trigger
+  PHASE_REFRESH,   // waiting for BUSY to release
+  PHASE_SLEEP,     // post refresh commands and deep sleep
+};
+
+enum BootReset : uint8_t {
+  BOOT_RESET_DONE = 0,
+  BOOT_RESET_LOW,   // reset pin held low for reset_duration_
+  BOOT_RESET_HIGH,  // released, waiting for the controller to start
+};
+
 class WaveshareEPaperBase
     : public display::DisplayBuffer,
       public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW,
@@ -25,31 +71,167 @@ class WaveshareEPaperBase
   void set_reset_duration(uint32_t reset_duration) {
     this->reset_duration_ = reset_duration;
   }
+  // Wait for the refresh from loop() instead of in update(). Reset and
+  // power-on waits still block, see RefreshPhase, as does the blanking
+  // refresh of anti_ghosting.
+  void set_async_refresh(bool async_refresh) {
+    this->async_refresh_ = async_refresh;
+  }
+  // Where buffer_ and the previous frame are allocated.
+  void set_buffer_placement(BufferPlacement placement) {
+    this->buffer_placement_ = placement;
+  }
+  // Storage for buffer_ sized at compile time, used instead of allocating it
+  // in setup_pins_() if it is large enough.
+  void set_static_buffer(uint8_t *buffer, size_t length) {
+    this->static_buffer_ = buffer;
+    this->static_buffer_length_ = length;
+  }
+  // Wait for BUSY to be released on its edge interrupt instead of polling
+  // it. ESP32 only, the busy pin must be an internal one.
+  void set_busy_interrupt(bool busy_interrupt) {
+    this->busy_interrupt_ = busy_interrupt;
+  }
+  // Light sleep while waiting for BUSY, woken by the busy pin or at the
+  // timeout. ESP32 only, the busy pin must be an internal one.
+  void set_light_sleep(bool light_sleep) { this->light_sleep_ = light_sleep; }
+  void set_skip_unchanged(bool skip_unchanged) {
+    this->skip_unchanged_ = skip_unchanged;
+  }
+  // Rotate in the buffer layout and on the controller instead of per pixel,
+  // see apply_native_rotation_().
+  void set_native_rotation(bool native_rotation) {
+    this->native_rotation_ = native_rotation;
+  }
+  // Keep the controller out of deep sleep for this long after a refresh, so
+  // closely spaced updates skip the reset and unchanged registers. 0 puts it
+  // to sleep right away.
+  void set_standby_timeout(uint32_t standby_timeout) {
+    this->standby_timeout_ = standby_timeout;
+  }
+  // Number of updates skipped because the frame did not change.
+  uint32_t get_skipped_refreshes() const { return this->skipped_refreshes_; }
+  // Total ms spent waiting for BUSY, and how much of it in light sleep.
+  uint32_t get_busy_wait_time() const { return this->busy_wait_time_; }
+  uint32_t get_busy_sleep_time() const { return this->busy_sleep_time_; }
+  void add_on_refresh_callback(std::function<void()> &&callback) {
+    this->refresh_callback_.add(std::move(callback));
+  }
 
   void command(uint8_t value);
   void data(uint8_t value);
   void cmd_data(const uint8_t *data, size_t length);
   void cmd_data(const uint8_t cmd, const uint8_t *data, size_t length);
 
-  virtual void display() = 0;
+  // Queue a command and its data bytes. Queued commands are sent in a single
+  // transaction, toggling DC inside it, by flush_commands_(), which runs
+  // before any other bus access or BUSY poll.
+  template<typename... Ts> void queue_command_(uint8_t cmd, Ts... data) {
+    const uint8_t bytes[] = {cmd, static_cast<uint8_t>(data)...};
+    this->queue_cmd_data_(bytes, sizeof(bytes));
+  }
+  void flush_commands_();
+  // Like queue_command_() / cmd_data() for registers and LUTs, but skipped if
+  // the controller already holds the same data, see shadow_update_().
+  template<typename... Ts> void queue_register_(uint8_t cmd, Ts... data) {
+    const uint8_t bytes[] = {cmd, static_cast<uint8_t>(data)...};
+    if (this->shadow_update_(cmd, bytes + 1, sizeof(bytes) - 1))
+      this->queue_cmd_data_(bytes, sizeof(bytes));
+  }
+  void write_register_(uint8_t cmd, const uint8_t *data, size_t length);
+
+  // Run all refresh phases, blocking until the panel is done.
+  virtual void display();
   virtual void initialize() = 0;
   virtual void deep_sleep() = 0;
 
+  bool is_refreshing() const { return this->phase_ != PHASE_IDLE; }
+
   void update() override;
+  void loop() override;
 
-  void setup() override {
-    this->setup_pins_();
-    this->initialize();
-  }
+  int get_width() override;
+  int get_height() override;
+
+  void setup() override;
 
   void on_safe_shutdown() override;
 
  protected:
+  // Refresh phases implemented by the drivers. prepare_display_() resets and
+  // programs the controller and returns false if there is nothing to show,
+  // transfer_display_() writes the frame and triggers the refresh, and
+  // finish_display_() runs once BUSY is released and puts the panel to sleep.
+  virtual bool prepare_display_() = 0;
+  virtual bool transfer_display_() = 0;
+  virtual void finish_display_() = 0;
+  // Drivers that do not wait for BUSY after triggering the refresh.
+  virtual bool refresh_uses_busy_() { return true; }
+  // Called once the lambda has drawn the frame, and once the panel shows it.
+  virtual void on_frame_drawn_() {}
+  virtual void on_frame_shown_() {}
+  // Whether buffer_ differs from the frame last shown on the panel.
+  virtual bool frame_changed_();
+  // Whether frame_changed_() compares frame hashes, only then is the drawn
+  // frame hashed.
+  virtual bool compares_hash_() { return true; }
+
+  // command is the first byte, length is the total including cmd
+  void queue_cmd_data_(const uint8_t *c_data, size_t length);
+  void queue_cmd_data_(uint8_t cmd, const uint8_t *data, size_t length);
+
+  // Init sequences are byte tables of entries cmd, flags | data length,
+  // data..., followed by a delay in ms if SEQ_DELAY is set. SEQ_WAIT waits
+  // for BUSY after the command (and the delay). Everything in between is
+  // queued, so it goes out in as few transactions as possible. Returns false
+  // if BUSY timed out.
+  static constexpr uint8_t SEQ_WAIT = 0x80;
+  static constexpr uint8_t SEQ_DELAY = 0x40;
+  static constexpr uint8_t SEQ_LENGTH = 0x3F;
+  bool run_sequence_(const uint8_t *sequence, size_t length);
+
+  void set_phase_(RefreshPhase phase);
+  void complete_refresh_();
+  void fail_refresh_();
+
+  // Register shadow: a hash of the data last written to each register since
+  // the controller was reset. Returns true, and records the data, if it
+  // differs. Drivers clear it whenever the controller loses its registers.
+  bool shadow_update_(uint8_t cmd, const uint8_t *data, size_t length);
+  void clear_shadow_() { this->shadow_len_ = 0; }
+  // For finish_display_() of drivers with a standby: true if deep sleep is
+  // deferred, in which case the driver only powers the panel off.
+  bool defer_deep_sleep_();
+
+  bool is_busy_();
   bool wait_until_idle_();
+#ifdef USE_ESP32
+  void setup_busy_interrupt_();
+  static void busy_isr_(WaveshareEPaperBase *arg);
+  // given by busy_isr_() when BUSY is released, taken by wait_until_idle_()
+  SemaphoreHandle_t busy_semaphore_{nullptr};
+  // Light sleep for at most timeout ms or until BUSY is released, returns
+  // false if the chip did not sleep.
+  bool light_sleep_until_idle_(uint32_t timeout);
+#endif
+  bool busy_interrupt_{false};
+  bool light_sleep_{false};
+  uint32_t busy_wait_time_{0}, busy_sleep_time_{0};  // ms
+
+  // The panel reset at boot runs from loop(), so it does not hold up the
+  // setup of later components. Returns true once it is done, waiting for
+  // the rest of it if asked; update() and display() do.
+  void start_boot_reset_();
+  bool poll_boot_reset_(bool wait);
 
   virtual bool is_busy_pin_inverted_() { return false; }
 
   void setup_pins_();
+  // Allocate a frame sized buffer as set by set_buffer_placement(), returns
+  // nullptr on failure.
+  uint8_t *allocate_buffer_(size_t length);
+  // Free a buffer from allocate_buffer_() with the matching allocator.
+  void free_buffer_(uint8_t *buffer, size_t length);
 
   void reset_() {
     if (this->reset_pin_ != nullptr) {
@@ -62,14 +244,89 @@ class WaveshareEPaperBase
 
   virtual int get_width_controller() { return this->get_width_internal(); };
 
+  // With native rotation buffer_ holds the frame as seen by the user, at 0
+  // degrees, and write_plane_() turns it into the controller layout. 180
+  // degrees is done by the controller itself where can_flip_scan_() is true.
+  void apply_native_rotation_();
+  // UC81xx controllers reverse their gate and source scan with the UD and SHL
+  // bits of the panel setting (0x00), pass its first byte through
+  // panel_setting_().
+  virtual bool can_flip_scan_() { return false; }
+  uint8_t panel_setting_(uint8_t value) const {
+    return this->scan_flipped_ ? value ^ 0x0C : value;
+  }
+  bool swaps_axes_() const {
+    return this->buffer_rotation_ == display::DISPLAY_ROTATION_90_DEGREES ||
+           this->buffer_rotation_ == display::DISPLAY_ROTATION_270_DEGREES;
+  }
+  // Size and bytes per row of buffer_, which is transposed when the axes swap.
+  int buffer_width_() {
+    return this->swaps_axes_() ? this->get_height_internal()
+                               : this->get_width_internal();
+  }
+  int buffer_height_() {
+    return this->swaps_axes_() ? this->get_width_internal()
+                               : this->get_height_internal();
+  }
+  uint32_t buffer_stride_() {
+    return this->swaps_axes_() ? this->get_height_internal() / 8u
+                               : this->get_width_controller() / 8u;
+  }
+
+  // Clip the half-open rectangle [x1, x2) x [y1, y2) to the panel, or the
+  // current band when paged, and the clipping region, returns false if
+  // nothing is left. Buffer coordinates equal display coordinates only at
+  // rotation 0.
+  bool clip_rect_(int &x1, int &y1, int &x2, int &y2);
+  // Per pixel fallback of draw_bitmap() for rotated displays.
+  void draw_bitmap_pixels_(int x, int y, int w, int h, const uint8_t *bitmap,
+                           Color color_on, Color color_off, bool transparent);
+#ifdef USE_IMAGE
+  static bool is_blittable_(image::Image *image) {
+#ifdef USE_ESP8266
+    // image data sits in PROGMEM there, only the image reads it byte wise
+    return false;
+#else
+    return image->get_type() == image::IMAGE_TYPE_BINARY;
+#endif
+  }
+#endif
+
   virtual uint32_t
   get_buffer_length_() = 0;  // NOLINT(readability-identifier-naming)
+  // Size of the allocated buffer_, smaller than a frame in paged mode.
+  virtual uint32_t get_buffer_alloc_length_() {
+    return this->get_buffer_length_();
+  }
   uint32_t reset_duration_{200};
 
   void start_command_();
   void end_command_();
   void start_data_();
   void end_data_();
+  // bulk writes, used between start_data_() and end_data_()
+  void write_bulk_(const uint8_t *data, size_t length);
+  void write_repeat_(uint8_t value, size_t length);
+  // Stream data through a small bounce buffer, applying transform to each
+  // chunk on the way, so no full size copy of the plane is needed.
+  using ChunkTransform = void (*)(uint8_t *dst, const uint8_t *src,
+                                  size_t length);
+  void write_transformed_(const uint8_t *data, size_t length,
+                          ChunkTransform transform);
+  void write_inverted_(const uint8_t *data, size_t length);
+  // Stream a plane laid out like buffer_ in controller order, inverted if
+  // asked. Drivers write buffer_ planes only through this.
+  void write_plane_(const uint8_t *plane, size_t length, bool invert = false);
+
+  // Set a whole controller RAM plane, selected by its write command, to value.
+  // The default streams the bytes; controllers with an on-chip pattern fill
+  // override it.
+  virtual bool fill_ram_(uint8_t ram_cmd, uint8_t value, size_t length);
+  // Auto write RAM (0x46 / 0x47) of SSD16xx controllers, over the RAM area
+  // set before. steps holds the step height (A[6:4]) and width (A[2:0])
+  // codes that cover the panel, they differ per controller.
+  bool ssd_auto_write_ram_(uint8_t ram_cmd, uint8_t value, size_t length,
+                           uint8_t steps);
 
   GPIOPin *reset_pin_{nullptr};
   GPIOPin *dc_pin_;
@@ -77,32 +334,353 @@ class WaveshareEPaperBase
   virtual uint32_t idle_timeout_() {
     return 1000u;
   }  // NOLINT(readability-identifier-naming)
+
+  static constexpr size_t BULK_CHUNK_SIZE = 64;
+  static constexpr size_t BOUNCE_BUFFER_SIZE = 256;
+  static const size_t COMMAND_QUEUE_SIZE = 64;
+  // entries are stored as cmd, data length, data...
+  uint8_t command_queue_[COMMAND_QUEUE_SIZE];
+  size_t command_queue_len_{0};
+
+  struct ShadowEntry {
+    uint8_t cmd;
+    uint32_t hash;
+  };
+  static const size_t SHADOW_SIZE = 16;
+  ShadowEntry shadow_[SHADOW_SIZE];
+  size_t shadow_len_{0};
+  uint32_t standby_timeout_{0};
+
+  // Paged rendering: buffer_ holds band_height_ rows starting at band_y_ and
+  // the lambda runs once per band, see WaveshareEPaperBWR. 0 is a full frame.
+  bool paged_() {
+    return this->band_height_ != 0 &&
+           this->band_height_ < this->buffer_height_();
+  }
+  // Last buffer row (exclusive) of the current band.
+  int band_end_();
+  uint16_t band_height_{0};
+  int band_y_{0};
+
+  bool native_rotation_{false};
+  // rotation applied by write_plane_(), rotation_ is 0 when this is in use
+  display::DisplayRotation buffer_rotation_{
+      display::DISPLAY_ROTATION_0_DEGREES};
+  bool scan_flipped_{false};
+  // 8 controller rows, for transposing the frame when the axes swap
+  uint8_t *band_buffer_{nullptr};
+
+  BufferPlacement buffer_placement_{PLACEMENT_AUTO};
+  uint8_t *static_buffer_{nullptr};
+  size_t static_buffer_length_{0};
+  bool async_refresh_{false};
+  bool skip_unchanged_{true};
+  // set by full_refresh() and until the first refresh succeeds, as the
+  // panel content is unknown
+  bool force_update_{true};
+  uint32_t skipped_refreshes_{0};
+  // hash of the frame drawn by update(), and of the one on the panel
+  uint32_t drawn_hash_{0}, shown_hash_{0};
+  bool drawn_hash_valid_{false}, shown_hash_valid_{false};
+  RefreshPhase phase_{PHASE_IDLE};
+  BootReset boot_reset_{BOOT_RESET_DONE};
+  uint32_t boot_reset_start_{0};
+  uint32_t setup_time_{0};  // us
+  uint32_t phase_start_{0};
+  CallbackManager<void()> refresh_callback_{};
+};
+
+class RefreshTrigger : public Trigger<> {
+ public:
+  explicit RefreshTrigger(WaveshareEPaperBase *parent) {
+    parent->add_on_refresh_callback([this]() { this->trigger(); });
+  }
 };
 
 class WaveshareEPaper : public WaveshareEPaperBase {
  public:
+  static constexpr uint8_t PLANES = 1;
+
   void fill(Color color) override;
 
+  // The lambda gets the driver itself as `it`, so the byte wide primitives
+  // below are used from it.filled_rectangle(...) and friends.
+  void set_writer(std::function<void(WaveshareEPaper &)> &&writer) {
+    display::Display::set_writer(
+        [this, writer](display::Display &) { writer(*this); });
+  }
+
+  // Byte wide versions of the Display primitives. They hide the per-pixel
+  // ones when called on the driver, e.g. it.filled_rectangle(...).
+  using display::Display::filled_rectangle;
+  using display::Display::horizontal_line;
+  void horizontal_line(int x, int y, int width,
+                       Color color = display::COLOR_ON);
+  void filled_rectangle(int x1, int y1, int width, int height,
+                        Color color = display::COLOR_ON);
+  void draw_pixels_at(int x_start, int y_start, int w, int h,
+                      const uint8_t *ptr, display::ColorOrder order,
+                      display::ColorBitness bitness, bool big_endian,
+                      int x_offset, int y_offset, int x_pad) override;
+
+  // Copy a 1bpp bitmap (MSB first, rows padded to whole bytes, set bits are
+  // on) to x, y with shifts and masks. Cleared bits get color_off, or are
+  // left alone if transparent.
+  void draw_bitmap(int x, int y, int w, int h, const uint8_t *bitmap,
+                   Color color_on = display::COLOR_ON,
+                   Color color_off = display::COLOR_OFF,
+                   bool transparent = false);
+#ifdef USE_IMAGE
+  // Binary images are blitted, other types are drawn by the image itself.
+  void draw_image(int x, int y, image::Image *image,
+                  Color color_on = display::COLOR_ON,
+                  Color color_off = display::COLOR_OFF);
+#endif
+
+  // Keep the previous frame run length coded instead of as a second frame
+  // buffer, for drivers that send it along with the new one.
+  void set_compress_previous(bool compress_previous) {
+    this->compress_previous_ = compress_previous;
+  }
+  // Save the frame shown, and the refresh counter, and restore them at boot,
+  // so the first update after deep sleep can still be a partial one. RTC
+  // memory is written with every refresh, flash only on shutdown. ESP32 only.
+  void set_frame_persistence(FramePersistence frame_persistence) {
+    this->frame_persistence_ = frame_persistence;
+  }
+  void on_safe_shutdown() override;
+  // Like set_static_buffer(), for the full previous frame.
+  void set_static_previous(uint8_t *previous, size_t length) {
+    this->static_previous_ = previous;
+    this->static_previous_length_ = length;
+  }
+
   display::DisplayType get_display_type() override {
     return display::DisplayType::DISPLAY_TYPE_BINARY;
   }
 
  protected:
   void draw_absolute_pixel_internal(int x, int y, Color color) override;
+  // draw_absolute_pixel_internal() for a buffer_ of the given size and
+  // stride, FixedGeometry inlines it with constants.
+  void set_pixel_(int x, int y, Color color, int width, int height,
+                  uint32_t stride) {
+    if (x >= width || y >= height || x < 0 || y < 0) return;
+
+    if (this->seed_pending_) this->seed_buffer_();
+
+    this->expand_dirty_(x, y, x, y);
+
+    const uint32_t pos = y * stride + x / 8u;
+    const uint8_t mask = 0x80 >> (x & 0x07);
+    // flip logic
+    if (!color.is_on()) {
+      this->buffer_[pos] |= mask;
+    } else {
+      this->buffer_[pos] &= ~mask;
+    }
+  }
   uint32_t get_buffer_length_() override;
+
+  // Dirty bounding box of buffer_ in controller coordinates (inclusive). It is
+  // empty while x1 > x2; after trim_dirty_() the x range is byte aligned.
+  bool is_dirty_() const { return this->dirty_x1_ <= this->dirty_x2_; }
+  void mark_all_dirty_();
+  void clear_dirty_();
+  void expand_dirty_(int x1, int y1, int x2, int y2) {
+    if (x1 < this->dirty_x1_) this->dirty_x1_ = x1;
+    if (x2 > this->dirty_x2_) this->dirty_x2_ = x2;
+    if (y1 < this->dirty_y1_) this->dirty_y1_ = y1;
+    if (y2 > this->dirty_y2_) this->dirty_y2_ = y2;
+  }
+  // Set the already clipped [x1, x2) x [y1, y2) of buffer_ to on or off.
+  void fill_rect_(int x1, int y1, int x2, int y2, bool on);
+  // Shrink the dirty box to the rows and bytes that differ from the previous
+  // frame, returns false if nothing changed.
+  bool trim_dirty_();
+  // Stream the dirty window of `plane` (laid out like buffer_) as data bytes.
+  void write_dirty_window_(const uint8_t *plane);
+
+  // Previous frame as shown on the panel, for drivers that send the old data
+  // along with the new one. It is swapped with buffer_ once a refresh
+  // succeeds, and buffer_ is seeded from it only if the next frame does not
+  // start with fill(). A failed refresh leaves both buffers untouched.
+  // With compress_previous the frame is run length coded into previous_rle_
+  // instead, and buffer_ is kept as it is.
+  // refresh_count, if given, is persisted along with the frame.
+  void init_previous_(uint32_t *refresh_count = nullptr);
+  // Stream the dirty window / all of the previous frame as data bytes.
+  void write_previous_window_();
+  void write_previous_();
+  // Set the previous frame to white, after the panel was cleared.
+  void clear_previous_();
+  // Compress buffer_ into previous_rle_.
+  void store_previous_();
+  // Frame persistence, the frame is kept run length coded. An invalid record
+  // is saved if not valid.
+  void save_frame_(bool valid = true);
+  bool restore_frame_();
+  void seed_buffer_();
+  void on_frame_drawn_() override;
+  void on_frame_shown_() override;
+  bool frame_changed_() override;
+  bool compares_hash_() override {
+    return !this->compress_previous_ && this->previous_ == nullptr;
+  }
+
+  uint16_t dirty_x1_{UINT16_MAX}, dirty_y1_{UINT16_MAX}, dirty_x2_{0},
+      dirty_y2_{0};
+  uint8_t *previous_{nullptr};
+  uint8_t *static_previous_{nullptr};
+  size_t static_previous_length_{0};
+  bool seed_pending_{false};
+  bool compress_previous_{false};
+  uint8_t *previous_rle_{nullptr};
+  size_t previous_rle_len_{0}, previous_rle_capacity_{0};
+  FramePersistence frame_persistence_{PERSIST_NONE};
+  // the panel shows the previous frame, shown or restored since boot
+  bool frame_known_{false};
+  // the restored flash record is still saved, the next refresh outdates it
+  bool flash_frame_stale_{false};
+  uint32_t *refresh_count_{nullptr};
+  ESPPreferenceObject frame_pref_;
 };
 
 class WaveshareEPaperBWR : public WaveshareEPaperBase {
  public:
+  static constexpr uint8_t PLANES = 2;
+
   void fill(Color color) override;
 
+  // See WaveshareEPaper::set_writer().
+  void set_writer(std::function<void(WaveshareEPaperBWR &)> &&writer) {
+    display::Display::set_writer(
+        [this, writer](display::Display &) { writer(*this); });
+  }
+
+  // Plane-aware versions of the Display primitives, see WaveshareEPaper.
+  using display::Display::filled_rectangle;
+  using display::Display::horizontal_line;
+  void horizontal_line(int x, int y, int width,
+                       Color color = display::COLOR_ON);
+  void filled_rectangle(int x1, int y1, int width, int height,
+                        Color color = display::COLOR_ON);
+  void draw_pixels_at(int x_start, int y_start, int w, int h,
+                      const uint8_t *ptr, display::ColorOrder order,
+                      display::ColorBitness bitness, bool big_endian,
+                      int x_offset, int y_offset, int x_pad) override;
+
+  // Copy a 1bpp bitmap (MSB first, rows padded to whole bytes, set bits are
+  // on) to x, y with shifts and masks. Cleared bits get color_off, or are
+  // left alone if transparent.
+  void draw_bitmap(int x, int y, int w, int h, const uint8_t *bitmap,
+                   Color color_on = display::COLOR_ON,
+                   Color color_off = display::COLOR_OFF,
+                   bool transparent = false);
+#ifdef USE_IMAGE
+  // Binary images are blitted, other types are drawn by the image itself.
+  void draw_image(int x, int y, image::Image *image,
+                  Color color_on = display::COLOR_ON,
+                  Color color_off = display::COLOR_OFF);
+#endif
+  // Copy a bitmap already split into black and red planes (same bit layout
+  // as draw_bitmap(), red may be nullptr) to x, y.
+  void draw_bitmap_planes(int x, int y, int w, int h, const uint8_t *black,
+                          const uint8_t *red);
+
+  // Render the frame in bands of this many rows to save RAM. The lambda is
+  // called once per band and only the band is kept in memory.
+  void set_band_height(uint16_t band_height) {
+    this->band_height_ = band_height;
+  }
+
   display::DisplayType get_display_type() override {
     return display::DisplayType::DISPLAY_TYPE_COLOR;
   }
 
  protected:
   void draw_absolute_pixel_internal(int x, int y, Color color) override;
+  // See WaveshareEPaper::set_pixel_(), height is that of the whole frame.
+  void set_pixel_(int x, int y, Color color, int width, int height,
+                  uint32_t stride) {
+    const int rows = this->band_height_ != 0 && this->band_height_ < height
+                         ? this->band_height_
+                         : height;
+    const int end = std::min(this->band_y_ + rows, height);
+    if (x >= width || y >= end || x < 0 || y < this->band_y_) return;
+
+    const PlaneBits bits = this->plane_bits_(color);
+
+    const uint32_t pos = (y - this->band_y_) * stride + x / 8u;
+    const uint8_t mask = 0x80 >> (x & 0x07);
+    uint8_t *black = this->buffer_ + pos;
+    uint8_t *red = black + stride * rows;
+    *black = (*black & ~mask) | (bits.black & mask);
+    *red = (*red & ~mask) | (bits.red & mask);
+  }
   uint32_t get_buffer_length_() override;
+  uint32_t get_buffer_alloc_length_() override {
+    return 2u * this->plane_length_();
+  }
+  // Bytes per plane in buffer_, the red plane follows the black one.
+  uint32_t plane_length_() {
+    return this->buffer_stride_() * (this->paged_() ? this->band_height_
+                                                    : this->buffer_height_());
+  }
+
+  // Draws the frame band by band if paged, writing each band to the
+  // controller with write_band_(), then starts the refresh with
+  // trigger_refresh_().
+  bool transfer_display_() override;
+  // Write rows y .. y + rows - 1 of both planes from buffer_ to controller RAM.
+  virtual void write_band_(int y, int rows) = 0;
+  virtual bool trigger_refresh_() = 0;
+
+  // Byte values (0x00 or 0xFF) a color sets in the black and red planes.
+  struct PlaneBits {
+    uint8_t black;
+    uint8_t red;
+  };
+  static PlaneBits classify_(Color color);
+  // classify_() with the last color cached, as primitives draw one color
+  PlaneBits plane_bits_(Color color) {
+    if (color.raw_32 != this->last_color_.raw_32) {
+      this->last_color_ = color;
+      this->last_bits_ = classify_(color);
+    }
+    return this->last_bits_;
+  }
+
+  Color last_color_{};
+  PlaneBits last_bits_{0x00, 0x00};
+};
+
+// A model whose size is known at compile time. The size getters return
+// constants and the pixel path is inlined with them, so drawing needs no
+// virtual calls past draw_absolute_pixel_internal(). Base is
+// WaveshareEPaper or WaveshareEPaperBWR.
+template<typename Base, uint16_t W, uint16_t H>
+class FixedGeometry : public Base {
+  static_assert(W % 8 == 0, "the width must be a whole number of bytes");
+
+ public:
+  static constexpr uint16_t WIDTH = W;
+  static constexpr uint16_t HEIGHT = H;
+
+ protected:
+  int get_width_internal() final { return W; }
+  int get_height_internal() final { return H; }
+  int get_width_controller() final { return W; }
+  uint32_t get_buffer_length_() final { return Base::PLANES * (W / 8u) * H; }
+
+  void HOT draw_absolute_pixel_internal(int x, int y, Color color) final {
+    // buffer_ is transposed with native rotation by 90 or 270 degrees
+    if (this->swaps_axes_()) {
+      this->set_pixel_(x, y, color, H, W, H / 8u);
+    } else {
+      this->set_pixel_(x, y, color, W, H, W / 8u);
+    }
+  }
 };
 
 }  // namespace waveshare_epaper